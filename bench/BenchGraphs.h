@@ -0,0 +1,44 @@
+#ifndef BENCHGRAPHS_H_INCLUDED
+#define BENCHGRAPHS_H_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "CSRGraph.h"
+#include "RandomGenerator.h"
+
+/**
+ * Deterministic graph for the benchmarks: the n nodes form communities of
+ * `community` consecutive nodes, and every node links to about degree / 2
+ * random nodes, 9 in 10 of them inside its own community. The average
+ * degree is about `degree`.
+ */
+inline CSRGraph plantedGraph(const size_t n, const size_t degree,
+                             const size_t community = 128) {
+  SequentialStream stream(0x5eedULL);
+  EdgeList edges;
+  edges.reserve(n * degree / 2);
+  for (size_t u = 0; u < n; u++) {
+    const size_t first = u / community * community;
+    const size_t size = std::min(community, n - first);
+    for (size_t e = 0; e < degree / 2; e++) {
+      const bool inside = stream.bounded(10) != 0;
+      const size_t v =
+          inside ? first + stream.bounded(static_cast<std::uint32_t>(size))
+                 : stream.bounded(static_cast<std::uint32_t>(n));
+      if (v != u) {
+        edges.emplace_back(static_cast<NodeId>(u), static_cast<NodeId>(v));
+      }
+    }
+  }
+  return CSRGraph::fromEdges(n, edges);
+}
+
+// Bytes of the CSR arrays of a graph
+inline std::int64_t csrBytes(const CSRView &graph) {
+  return static_cast<std::int64_t>((graph.size() + 1) * sizeof(std::uint64_t) +
+                                   graph.entries() * sizeof(NodeId));
+}
+
+#endif // BENCHGRAPHS_H_INCLUDED
@@ -0,0 +1,40 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "BenchGraphs.h"
+#include "ClusteredGraph.h"
+#include "ThreadPool.h"
+
+namespace {
+
+// Arguments: nodes per cluster, threads; three clusters with overlaps
+void BM_ClusteredGraph(benchmark::State &state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  ThreadPool pool(static_cast<size_t>(state.range(1)));
+  ClusteredGraph graph(n, {0, n / 50, n / 100}, &pool);
+
+  std::int64_t entries = 0;
+  std::int64_t bytes = 0;
+  for (auto _ : state) {
+    graph.generateGraph();
+    entries += static_cast<std::int64_t>(graph.getAdjList().entries());
+    bytes += csrBytes(graph.getAdjList());
+    state.PauseTiming();
+    graph.deleteGraph();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(entries); // adjacency entries
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_ClusteredGraph)
+    ->ArgNames({"nodes", "threads"})
+    ->Args({1000, 1})
+    ->Args({4000, 1})
+    ->Args({4000, 4})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+} // namespace
@@ -0,0 +1,125 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "BenchGraphs.h"
+#include "OverCoDe.h"
+#include "ThreadPool.h"
+
+// Runs the phases of OverCoDe::runOverCoDe one at a time
+struct OverCoDeBenchmark {
+  // All ell executions of the distributed process
+  static void signatures(OverCoDe &overcode) {
+    overcode.si.reset(overcode.G.size(), overcode.ell);
+    overcode.generateRuns(0, overcode.ell, overcode.si, overcode.nextKey());
+    overcode.runsDone = overcode.ell;
+  }
+
+  // Picking the representatives among the pure signatures
+  static size_t representatives(const OverCoDe &overcode) {
+    std::vector<std::uint64_t> decided(overcode.G.size());
+    std::vector<size_t> pure;
+    for (size_t u = 0; u < decided.size(); u++) {
+      decided[u] = overcode.si.decidedCount(u);
+      if (static_cast<double>(decided[u]) >=
+          overcode.beta * static_cast<double>(overcode.runsDone)) {
+        pure.push_back(u);
+      }
+    }
+    return overcode
+        .clustersIDs(overcode.si, overcode.runsDone, pure, overcode.beta,
+                     decided)
+        .size();
+  }
+
+  // Purity filter, representatives and the assignment of every node
+  static size_t clustering(const OverCoDe &overcode) {
+    return overcode.clusterSignatures().memberships.entries();
+  }
+};
+
+namespace {
+
+// Parameters as the ego graph experiments derive them for clusters of 128
+OverCoDe makeOverCoDe(const CSRGraph &graph, const size_t ell,
+                      const SignatureEngine engine, ThreadPool &pool) {
+  const double logn = std::log2(128.0);
+  OverCoDeOptions options;
+  options.engine = engine;
+  options.seed = 1;
+  return OverCoDe(graph, static_cast<int>(50 * logn),
+                  static_cast<int>(2 * std::sqrt(128.0) * logn), 3,
+                  static_cast<int>(2 * std::sqrt(128.0)), ell, 0.85, 0.92,
+                  options, &pool);
+}
+
+// Arguments: nodes, degree, ell, threads
+void applyShapes(benchmark::internal::Benchmark *bench) {
+  bench->ArgNames({"nodes", "degree", "ell", "threads"});
+  for (const std::int64_t nodes : {1024, 8192}) {
+    for (const std::int64_t degree : {16, 64}) {
+      bench->Args({nodes, degree, 128, 1});
+    }
+  }
+  bench->Args({8192, 16, 512, 1});
+  bench->Args({8192, 16, 512, 4});
+  bench->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+template <SignatureEngine Engine>
+void BM_Signatures(benchmark::State &state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const CSRGraph graph = plantedGraph(n, static_cast<size_t>(state.range(1)));
+  const auto ell = static_cast<size_t>(state.range(2));
+  ThreadPool pool(static_cast<size_t>(state.range(3)));
+  OverCoDe overcode = makeOverCoDe(graph, ell, Engine, pool);
+
+  for (auto _ : state) {
+    OverCoDeBenchmark::signatures(overcode);
+  }
+  // Items: node executions; bytes: adjacency read once per execution
+  const auto runs = static_cast<std::int64_t>(state.iterations() * ell);
+  state.SetItemsProcessed(runs * static_cast<std::int64_t>(n));
+  state.SetBytesProcessed(runs * csrBytes(graph));
+}
+BENCHMARK(BM_Signatures<SignatureEngine::Bitsliced>)->Apply(applyShapes);
+BENCHMARK(BM_Signatures<SignatureEngine::Scalar>)->Apply(applyShapes);
+
+void BM_Representatives(benchmark::State &state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const CSRGraph graph = plantedGraph(n, static_cast<size_t>(state.range(1)));
+  const auto ell = static_cast<size_t>(state.range(2));
+  ThreadPool pool(static_cast<size_t>(state.range(3)));
+  OverCoDe overcode =
+      makeOverCoDe(graph, ell, SignatureEngine::Bitsliced, pool);
+  OverCoDeBenchmark::signatures(overcode);
+
+  size_t found = 0;
+  for (auto _ : state) {
+    found = OverCoDeBenchmark::representatives(overcode);
+  }
+  state.counters["representatives"] = static_cast<double>(found);
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK(BM_Representatives)->Apply(applyShapes);
+
+void BM_Clustering(benchmark::State &state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const CSRGraph graph = plantedGraph(n, static_cast<size_t>(state.range(1)));
+  const auto ell = static_cast<size_t>(state.range(2));
+  ThreadPool pool(static_cast<size_t>(state.range(3)));
+  OverCoDe overcode =
+      makeOverCoDe(graph, ell, SignatureEngine::Bitsliced, pool);
+  OverCoDeBenchmark::signatures(overcode);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(OverCoDeBenchmark::clustering(overcode));
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK(BM_Clustering)->Apply(applyShapes);
+
+} // namespace
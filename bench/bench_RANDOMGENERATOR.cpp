@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "CSRGraph.h"
+#include "PushPhase.h"
+#include "RandomGenerator.h"
+
+namespace {
+
+template <class Stream> Stream makeStream() { return Stream(42); }
+
+template <class Stream> void BM_Next64(benchmark::State &state) {
+  Stream stream = makeStream<Stream>();
+  stream.position(0, 0, 0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(stream.next64());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * 8);
+}
+BENCHMARK(BM_Next64<SequentialStream>);
+BENCHMARK(BM_Next64<CounterStream>);
+
+// Neighbor draws as the majority rounds make them, range = degree
+template <class Stream> void BM_Bounded(benchmark::State &state) {
+  Stream stream = makeStream<Stream>();
+  const auto range = static_cast<std::uint32_t>(state.range(0));
+  std::uint32_t node = 0;
+  for (auto _ : state) {
+    stream.position(0, 2, node++);
+    benchmark::DoNotOptimize(stream.bounded(range));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Bounded<SequentialStream>)->ArgName("range")->Arg(17)->Arg(1000);
+BENCHMARK(BM_Bounded<CounterStream>)->ArgName("range")->Arg(17)->Arg(1000);
+
+// Geometric skip sampling, items = candidates covered
+void BM_BernoulliIndices(benchmark::State &state) {
+  SequentialStream stream(42);
+  const double p = 1.0 / static_cast<double>(state.range(0));
+  constexpr std::uint64_t COUNT = 1 << 20;
+  std::uint64_t hits = 0;
+  for (auto _ : state) {
+    bernoulliIndices(stream, COUNT, p, [&hits](std::uint64_t) { hits++; });
+  }
+  benchmark::DoNotOptimize(hits);
+  state.SetItemsProcessed(state.iterations() * COUNT);
+}
+BENCHMARK(BM_BernoulliIndices)->ArgName("1/p")->Arg(2)->Arg(100)->Arg(10000);
+
+// Pushes of one node with the given degree, sampled one by one or as a
+// multinomial; items = pushes. The ratio of pushes per neighbor at which
+// both take equally long is MULTINOMIAL_MIN_PUSHES_PER_NEIGHBOR.
+template <PushSampling Sampling> void BM_PushTokens(benchmark::State &state) {
+  const auto degree = static_cast<unsigned long long>(state.range(0));
+  const auto k = static_cast<int>(state.range(0) * state.range(1));
+  std::vector<std::vector<unsigned long long>> star(degree + 1);
+  for (unsigned long long v = 1; v <= degree; v++) {
+    star[0].push_back(v);
+    star[v].push_back(0);
+  }
+  const CSRGraph graph(star);
+  std::vector<int> inbox(graph.size());
+  SequentialStream stream(42);
+  for (auto _ : state) {
+    pushTokens(graph[0], k, 1, Sampling, inbox, stream);
+  }
+  benchmark::DoNotOptimize(inbox.data());
+  state.SetItemsProcessed(state.iterations() * k);
+}
+BENCHMARK(BM_PushTokens<PushSampling::Exact>)
+    ->ArgNames({"degree", "pushes/neighbor"})
+    ->ArgsProduct({{16, 1024}, {1, 4, 16, 32, 48, 64, 256}});
+BENCHMARK(BM_PushTokens<PushSampling::Multinomial>)
+    ->ArgNames({"degree", "pushes/neighbor"})
+    ->ArgsProduct({{16, 1024}, {1, 4, 16, 32, 48, 64, 256}});
+
+} // namespace
@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "RandomGenerator.h"
+#include "SignatureMatrix.h"
+
+namespace {
+
+// Rows of `ell` random positions, about one in eight undecided
+SignatureMatrix randomSignatures(const size_t rows, const size_t ell) {
+  SignatureMatrix signatures(rows, ell);
+  SequentialStream stream(7);
+  for (size_t u = 0; u < rows; u++) {
+    for (size_t w = 0; w * 64 < ell; w++) {
+      const std::uint64_t decided =
+          stream.next64() | stream.next64() | stream.next64();
+      const size_t used = std::min<size_t>(64, ell - w * 64);
+      const std::uint64_t mask =
+          used == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << used) - 1;
+      signatures.setWord(u, w, decided & mask, stream.next64());
+    }
+  }
+  return signatures;
+}
+
+constexpr size_t ROWS = 1024;
+
+// Bytes of the two rows a comparison reads
+std::int64_t pairBytes(const SignatureMatrix &signatures) {
+  return static_cast<std::int64_t>(4 * signatures.wordsPerRow() *
+                                   sizeof(std::uint64_t));
+}
+
+void BM_Similarity(benchmark::State &state) {
+  const SignatureMatrix signatures =
+      randomSignatures(ROWS, static_cast<size_t>(state.range(0)));
+  size_t row = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        similarity(signatures.row(row), signatures.row(row + 1)));
+    row = (row + 2) % ROWS;
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * pairBytes(signatures));
+}
+BENCHMARK(BM_Similarity)->ArgName("ell")->RangeMultiplier(4)->Range(64, 16384);
+
+// Random signatures agree on about half their positions, so a threshold of
+// 0.85 stops the scan after the first block
+void BM_IsSimilar(benchmark::State &state) {
+  const auto ell = static_cast<size_t>(state.range(0));
+  const SignatureMatrix signatures = randomSignatures(ROWS, ell);
+  size_t row = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(isSimilar(signatures.row(row),
+                                       signatures.row(row + 1), 0.85, ell));
+    row = (row + 2) % ROWS;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IsSimilar)->ArgName("ell")->RangeMultiplier(4)->Range(64, 16384);
+
+} // namespace
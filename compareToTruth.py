@@ -50,6 +50,10 @@ def read_cluster_file(filename):
 
 
 def read_truth(filename):
+    """
+    Truth files hold every graph once, under a "graph nodes n" line, stored
+    here as (graph, None). Older ones repeat it under each "graph run" line.
+    """
     read_clusters = {}
     current_graph = None
     current_clusters = []
@@ -57,6 +61,14 @@ def read_truth(filename):
     with open(filename, "r") as file:
         for line in file:
 
+            if len(line.strip().split()) == 3 and line.split()[1] == "nodes":
+                if current_graph is not None:
+                    read_clusters[current_graph] = current_clusters
+
+                current_graph = (int(line.split()[0]), None)
+                current_clusters = []
+                continue
+
             if len(line.strip().split()) == 2:
                 if line.strip().split()[0] == "Cluster":
                     continue
@@ -82,6 +94,19 @@ def read_truth(filename):
     return read_clusters
 
 
+def truth_of_runs(truth, clusters):
+    """
+    The truth of every (graph, run) of the cluster file, taken from the
+    truth of its graph if the truth file holds every graph once.
+    """
+    runs = {}
+    for graph_id in set(clusters.keys()).union(truth.keys()):
+        if graph_id[1] is None:
+            continue
+        runs[graph_id] = truth.get(graph_id, truth.get((graph_id[0], None), []))
+    return runs
+
+
 def display_and_save_results(
     results,
     jaccard_summary_data,
@@ -546,7 +571,7 @@ def main():
     parser.add_argument("-m", action="store_true", help="Minimal output")
     args = parser.parse_args()
     clusters = read_cluster_file(args.inputFile)
-    truth = read_truth(args.truthFile)
+    truth = truth_of_runs(read_truth(args.truthFile), clusters)
     compare_files(clusters, truth, args.graphs, args.runs, args.name, args.m)
 
 
@@ -4,11 +4,25 @@
 #include <string>
 #include <vector>
 
+#include "EgoGraphParams.h"
+#include "OverCoDeOptions.h"
+
 struct AppParams {
+  bool evaluationMode = false; // score OutputFile against OutputFile_truth
   bool isEgoGraph = false;
   double alpha = 0.0;
   double beta = 0.0;
   std::string filename;
+  std::string graphFile;   // edge list or snapshot to read instead of
+                           // generating graphs
+  std::string saveGraph;   // snapshot file to store every graph in
+  std::string profileFile; // per-run phase times and counts, JSON or CSV
+  std::string traceFile;   // Chrome trace of the worker threads
+  std::string evaluationFile; // per-run scores against the truth, CSV
+
+  // Sweep: cluster every run for all these alphas and betas at once
+  std::vector<double> sweepAlphas;
+  std::vector<double> sweepBetas;
   int graphs = 0;
   int runs = 0;
   std::vector<unsigned long long> overlaps{0};
@@ -20,6 +34,10 @@ struct AppParams {
   int l = 0;   // iterations
   int rho = 3; // majority samples
   int h = 0;   // sampling neighbors
+
+  // optional --name=value flags
+  OverCoDeOptions options;
+  EgoGraphParams ego; // shape of the ego graphs
 };
 
 AppParams parseArgs(int argc, char *argv[]);
@@ -0,0 +1,50 @@
+#ifndef BITOPS_H_INCLUDED
+#define BITOPS_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Helpers for vectors of bits packed into 64-bit words
+namespace bits {
+
+constexpr size_t WORD_BITS = 64;
+
+// Number of words needed to hold n bits
+inline size_t wordsFor(const size_t n) {
+  return (n + WORD_BITS - 1) / WORD_BITS;
+}
+
+inline bool test(const std::vector<std::uint64_t> &words, const size_t i) {
+  return ((words[i / WORD_BITS] >> (i % WORD_BITS)) & 1U) != 0;
+}
+
+inline unsigned popcount(const std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned>(__builtin_popcountll(word));
+#else
+  std::uint64_t x = word - ((word >> 1) & 0x5555555555555555ULL);
+  x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+  x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return static_cast<unsigned>((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Index of the lowest set bit, word must not be 0
+inline size_t countTrailingZeros(const std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<size_t>(__builtin_ctzll(word));
+#else
+  return popcount((word & (0 - word)) - 1);
+#endif
+}
+
+// Mask selecting the bits of the last word that belong to an n-bit vector
+inline std::uint64_t tailMask(const size_t n) {
+  const size_t used = n % WORD_BITS;
+  return used == 0 ? ~std::uint64_t{0} : (std::uint64_t{1} << used) - 1;
+}
+
+} // namespace bits
+
+#endif // BITOPS_H_INCLUDED
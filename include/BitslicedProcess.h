@@ -0,0 +1,394 @@
+#ifndef BITSLICEDPROCESS_H_INCLUDED
+#define BITSLICEDPROCESS_H_INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "BitOps.h"
+#include "CSRGraph.h"
+#include "OverCoDeOptions.h"
+#include "PushPhase.h"
+#include "RandomGenerator.h"
+#include "RunProfile.h"
+#include "StoppingRule.h"
+#include "Team.h"
+
+/**
+ * Runs up to 64 independent executions of the distributed process at once.
+ * Every node's state is one 64-bit word whose bit i is its token in run i
+ * (set = R). The ρ samples of a round are combined with a bitwise majority
+ * circuit, the R rounds of every run are tallied in bitsliced counters, and
+ * the stopping rule and alpha thresholds are evaluated on those counters.
+ *
+ * Only that bookkeeping is shared by the runs. Every run still draws its own
+ * neighbors, one gather per lane and sample in the majority rounds, and the
+ * push and pull phases execute lane by lane as in the scalar process; the
+ * runs would no longer be independent if they shared draws. Where the push
+ * phase dominates (large k), the engine is little faster than the scalar
+ * one.
+ *
+ * The object owns its scratch buffers; they grow with the graph and are
+ * reused by later calls. A team of threads may execute a call together, all
+ * members passing the same object; each then handles a share of the nodes.
+ */
+class BitslicedProcess {
+public:
+  static constexpr size_t MAX_LANES = bits::WORD_BITS;
+
+  explicit BitslicedProcess(const OverCoDeOptions &opts = OverCoDeOptions())
+      : options(opts) {}
+
+  // Options of the following runs; the buffers are kept
+  void setOptions(const OverCoDeOptions &opts) { options = opts; }
+
+  /**
+   * Executes runs firstRun .. firstRun + lanes - 1, drawing from the given
+   * stream (see RandomGenerator.h). On return bit i of red[u] (blue[u]) is set
+   * if node u decided R (B) in run firstRun + i; both unset means undecided.
+   * Bits at positions >= lanes are zero. With a team, red and blue are only
+   * complete once all members returned, and hold this member's share before.
+   * If counters are given, the member adds its phase times and per-round
+   * flips to them.
+   */
+  template <class Stream>
+  void run(const CSRView &graph, const size_t T_dist, const int k_dist,
+           const int rho_dist, const int h_dist, const double alpha_dist,
+           Stream &stream, const size_t firstRun, const size_t lanes,
+           std::vector<std::uint64_t> &red, std::vector<std::uint64_t> &blue) {
+    run(graph, T_dist, k_dist, rho_dist, h_dist, alpha_dist, stream, firstRun,
+        lanes, Team(), red, blue);
+  }
+
+  template <class Stream>
+  void run(const CSRView &graph, const size_t T_dist, const int k_dist,
+           const int rho_dist, const int h_dist, const double alpha_dist,
+           Stream &stream, const size_t firstRun, const size_t lanes,
+           const Team &team, std::vector<std::uint64_t> &red,
+           std::vector<std::uint64_t> &blue,
+           PhaseCounters *counters = nullptr) {
+    PhaseTimer timer(counters, options.tracer);
+    if (lanes == 0 || lanes > MAX_LANES) {
+      throw std::invalid_argument("lanes must be between 1 and 64");
+    }
+    if (rho_dist < 0 || rho_dist > MAX_RHO) {
+      throw std::invalid_argument("rho is too large for bitsliced counting");
+    }
+
+    const size_t n = graph.size();
+    const std::uint64_t laneMask =
+        lanes == MAX_LANES ? ~std::uint64_t{0}
+                           : (std::uint64_t{1} << lanes) - 1;
+
+    if (team.rank == 0) {
+      tallyPlanes = 1;
+      while ((std::uint64_t{1} << tallyPlanes) <= T_dist) {
+        tallyPlanes++;
+      }
+      states[0].resize(n);
+      states[1].resize(n);
+      tally.resize(n * tallyPlanes);
+      inboxes.resize(team.size);
+      for (auto &inbox : inboxes) {
+        inbox.resize(n);
+      }
+      randomBuffers.resize(team.size);
+      flipCount.resize(team.size);
+      openMembers.resize(team.size);
+      red.resize(n);
+      blue.resize(n);
+    }
+    team.sync();
+
+    const auto [first, last] = team.range(n);
+    std::vector<std::uint32_t> &randomBuffer = randomBuffers[team.rank];
+    randomBuffer.resize(lanes * static_cast<size_t>(rho_dist));
+    std::fill(tally.begin() + static_cast<std::ptrdiff_t>(first * tallyPlanes),
+              tally.begin() + static_cast<std::ptrdiff_t>(last * tallyPlanes),
+              0);
+
+    // Random Initialization: Round 0
+    for (size_t u = first; u < last; u++) {
+      stream.position(firstRun, StreamRound::INIT, static_cast<NodeId>(u));
+      states[0][u] = stream.next64();
+      states[1][u] = 0;
+    }
+    team.sync();
+    timer.charge(Phase::Push);
+
+    // Symmetry Breaking, one run at a time
+    for (size_t lane = 0; lane < lanes; lane++) {
+      symmetryBreaking(graph, k_dist, h_dist, stream, firstRun + lane, lane,
+                       team, timer);
+    }
+
+    // ρ-Majority process, all runs at once; round t is in states[t % 2]
+    StoppingRule rule(options, T_dist, alpha_dist);
+    for (size_t t = 2; t <= T_dist + 1; t++) {
+      const std::vector<std::uint64_t> &previous = states[(t - 1) % 2];
+      std::vector<std::uint64_t> &current = states[t % 2];
+      for (size_t u = first; u < last; u++) {
+        stream.position(firstRun, StreamRound::of(t), static_cast<NodeId>(u));
+        const std::uint64_t state =
+            majorityRound(graph, u, rho_dist, lanes, previous, randomBuffer,
+                          stream) &
+            laneMask;
+        current[u] = state;
+        addToTally(u, state);
+      }
+
+      // Statistics of this round, summed over the team after the sync
+      const size_t elapsed = t - 1;
+      std::uint64_t flips = 0;
+      if (rule.countsFlips() || counters != nullptr) {
+        for (size_t u = first; u < last; u++) {
+          flips += bits::popcount(previous[u] ^ current[u]);
+        }
+      }
+      flipCount.part(t, team.rank) = flips;
+      if (counters != nullptr) {
+        counters->addRound(elapsed, team.rank == 0 ? lanes : 0, flips);
+      }
+      bool fixed = rule.checksDecisions();
+      for (size_t u = first; fixed && u < last; u++) {
+        for (const std::uint64_t minRed : rule.minReds()) {
+          fixed = fixed && (fixedLanes(u, minRed, T_dist, elapsed) &
+                            laneMask) == laneMask;
+        }
+      }
+      openMembers.part(t, team.rank) = fixed ? 0 : 1;
+      team.sync();
+
+      if (rule.stop(elapsed, openMembers.total(t) == 0, flipCount.total(t),
+                    n * lanes)) {
+        // The remaining rounds repeat the last one
+        const size_t remaining = T_dist - elapsed;
+        for (size_t u = first; u < last; u++) {
+          for (size_t b = 0; (remaining >> b) != 0; b++) {
+            if (((remaining >> b) & 1U) != 0) {
+              addToTally(u, current[u], b);
+            }
+          }
+        }
+        break;
+      }
+    }
+    timer.charge(Phase::Majority);
+
+    // Threshold the tallies, R takes precedence as in the scalar process
+    const std::uint64_t minRed = rule.minRed(); // tallyR >= alpha * T
+    for (size_t u = first; u < last; u++) {
+      const std::uint64_t *planes = &tally[u * tallyPlanes];
+      const std::uint64_t isRed =
+          minRed == 0 ? laneMask : greaterThan(planes, minRed - 1);
+      // T - tallyR >= threshold  <=>  tallyR <= T - minRed
+      const std::uint64_t isBlue =
+          minRed > T_dist ? 0 : ~greaterThan(planes, T_dist - minRed);
+      red[u] = isRed & laneMask;
+      blue[u] = isBlue & ~isRed & laneMask;
+    }
+    timer.charge(Phase::Tally);
+  }
+
+  // Number of rounds node u spent as R in lane `lane` of the last run()
+  std::uint64_t tallyR(const size_t u, const size_t lane) const {
+    const std::uint64_t *planes = &tally[u * tallyPlanes];
+    std::uint64_t count = 0;
+    for (size_t b = 0; b < tallyPlanes; b++) {
+      count |= ((planes[b] >> lane) & 1U) << b;
+    }
+    return count;
+  }
+
+private:
+  // Bitsliced counters for ρ hold at most 8 planes
+  static constexpr int MAX_RHO = 255;
+
+  OverCoDeOptions options;
+
+  std::vector<std::uint64_t> states[2]; // rounds t - 1 and t
+  std::vector<std::uint64_t> tally; // tallyPlanes words per node, LSB first
+  std::vector<std::vector<int>> inboxes; // one per team member
+  std::vector<std::vector<std::uint32_t>> randomBuffers;
+  TeamSum flipCount;   // lanes flipped in a round, over all nodes
+  TeamSum openMembers; // members with open decisions after a round
+  size_t tallyPlanes = 1;
+
+  // Push and pull phase of a single run, its round 0 tokens are the bits at
+  // `lane` of states[0] and its round 1 tokens are written to states[1]
+  template <class Stream>
+  void symmetryBreaking(const CSRView &graph, const int k_dist,
+                        const int h_dist, Stream &stream, const size_t runId,
+                        const size_t lane, const Team &team,
+                        PhaseTimer &timer) {
+    const auto [first, last] = team.range(graph.size());
+    std::vector<int> &inbox = inboxes[team.rank];
+    std::vector<int> &merged = inboxes[0];
+    std::fill(inbox.begin(), inbox.end(), 0);
+
+    // Step 1: Push tokens to k neighbors, into this member's inbox
+    for (size_t u = first; u < last; u++) {
+      const auto neighbors = graph[u];
+      if (neighbors.empty())
+        continue;
+
+      const int val = ((states[0][u] >> lane) & 1U) != 0 ? 1 : -1;
+      stream.position(runId, StreamRound::PUSH, static_cast<NodeId>(u));
+      pushTokens(neighbors, k_dist, val, options.pushSampling, inbox,
+                 stream);
+    }
+    team.sync();
+
+    // Sum the inboxes of all members into the first one
+    if (team.size > 1) {
+      for (size_t r = 1; r < team.size; r++) {
+        for (size_t u = first; u < last; u++) {
+          merged[u] += inboxes[r][u];
+        }
+      }
+      team.sync();
+    }
+    timer.charge(Phase::Push);
+
+    // Step 2: Sample h neighbors and check their inboxes
+    for (size_t u = first; u < last; u++) {
+      long long balance = 0;
+      const auto neighbors = graph[u];
+      stream.position(runId, StreamRound::of(1), static_cast<NodeId>(u));
+      if (!neighbors.empty()) {
+        const auto sz = static_cast<std::uint32_t>(neighbors.size());
+        for (int i = 0; i < h_dist; i++) {
+          balance += merged[neighbors[stream.bounded(sz)]];
+        }
+      }
+
+      const bool isRed =
+          balance > 0 || (balance == 0 && (stream.next32() & 1U) == 0);
+      if (isRed) {
+        states[1][u] |= std::uint64_t{1} << lane;
+      }
+    }
+    // The next run resets the inboxes
+    team.sync();
+    timer.charge(Phase::Pull);
+  }
+
+  // Next state of node u in every lane
+  template <class Stream>
+  std::uint64_t majorityRound(const CSRView &graph, const size_t u,
+                              const int rho_dist, const size_t lanes,
+                              const std::vector<std::uint64_t> &previous,
+                              std::vector<std::uint32_t> &randomBuffer,
+                              Stream &stream) {
+    const auto neighbors = graph[u];
+    const auto degree = static_cast<std::uint32_t>(neighbors.size());
+    if (degree == 0 || rho_dist == 0) {
+      return stream.next64(); // no samples, every run is a tie
+    }
+
+    // All neighbor choices of this node and round in one batch
+    const auto samples = static_cast<size_t>(rho_dist);
+    stream.fill(randomBuffer.data(), samples * lanes);
+
+    // One word per sample: bit i is the colour run i saw
+    auto sample = [&](const size_t j) {
+      const std::uint32_t *draws = &randomBuffer[j * lanes];
+      std::uint64_t word = 0;
+      for (size_t lane = 0; lane < lanes; lane++) {
+        const NodeId v = neighbors[lemireBounded(draws[lane], degree, stream)];
+        word |= previous[v] & (std::uint64_t{1} << lane);
+      }
+      return word;
+    };
+
+    if (samples == 3) {
+      const std::uint64_t a = sample(0);
+      const std::uint64_t b = sample(1);
+      const std::uint64_t c = sample(2);
+      return (a & b) | (c & (a | b));
+    }
+
+    // General ρ: count the R samples per run in bitsliced counters
+    std::uint64_t count[8] = {};
+    for (size_t j = 0; j < samples; j++) {
+      std::uint64_t carry = sample(j);
+      for (size_t b = 0; carry != 0 && b < 8; b++) {
+        const std::uint64_t next = count[b] & carry;
+        count[b] ^= carry;
+        carry = next;
+      }
+    }
+
+    const auto half = static_cast<std::uint64_t>(samples / 2);
+    std::uint64_t state = greaterThan(count, 8, half);
+    if (samples % 2 == 0) {
+      // countR == countB, break the tie at random
+      state |= greaterThan(count, 8, half - 1) & ~state & stream.next64();
+    }
+    return state;
+  }
+
+  // Adds carry << plane to the counters of node u
+  void addToTally(const size_t u, std::uint64_t carry, const size_t plane = 0) {
+    std::uint64_t *planes = &tally[u * tallyPlanes];
+    for (size_t b = plane; carry != 0 && b < tallyPlanes; b++) {
+      const std::uint64_t next = planes[b] & carry;
+      planes[b] ^= carry;
+      carry = next;
+    }
+  }
+
+  // Lanes in which the decision of node u after `elapsed` of T_dist rounds
+  // no longer depends on the remaining rounds, see StoppingRule
+  std::uint64_t fixedLanes(const size_t u, const std::uint64_t minRed,
+                           const std::uint64_t T_dist,
+                           const std::uint64_t elapsed) const {
+    const std::uint64_t *planes = &tally[u * tallyPlanes];
+    if (minRed == 0) {
+      return ~std::uint64_t{0};
+    }
+    const std::uint64_t isRed = greaterThan(planes, minRed - 1);
+    const std::uint64_t remaining = T_dist - elapsed;
+    // tallyR + remaining < minRed
+    const std::uint64_t cannotRed =
+        minRed > remaining ? ~greaterThan(planes, minRed - remaining - 1) : 0;
+    if (minRed > T_dist) {
+      return isRed | cannotRed;
+    }
+    const std::uint64_t maxBlue = T_dist - minRed;
+    const std::uint64_t alwaysBlue =
+        maxBlue >= remaining ? ~greaterThan(planes, maxBlue - remaining) : 0;
+    const std::uint64_t neverBlue = greaterThan(planes, maxBlue);
+    return isRed | (cannotRed & (alwaysBlue | neverBlue));
+  }
+
+  std::uint64_t greaterThan(const std::uint64_t *planes,
+                            const std::uint64_t value) const {
+    return greaterThan(planes, tallyPlanes, value);
+  }
+
+  // Lanes whose bitsliced counter (LSB first) is strictly above value
+  static std::uint64_t greaterThan(const std::uint64_t *planes,
+                                   const size_t planeCount,
+                                   const std::uint64_t value) {
+    if (planeCount < 64 && (value >> planeCount) != 0) {
+      return 0; // value is not representable, no counter exceeds it
+    }
+    std::uint64_t greater = 0;
+    std::uint64_t equal = ~std::uint64_t{0};
+    for (size_t b = planeCount; b-- > 0;) {
+      if (((value >> b) & 1U) != 0) {
+        equal &= planes[b];
+      } else {
+        greater |= equal & planes[b];
+        equal &= ~planes[b];
+      }
+    }
+    return greater;
+  }
+};
+
+#endif // BITSLICEDPROCESS_H_INCLUDED
@@ -0,0 +1,228 @@
+#ifndef CSRGRAPH_H_INCLUDED
+#define CSRGRAPH_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Node ids are 32 bits wide; graphs with 2^32 or more nodes are rejected.
+using NodeId = std::uint32_t;
+using EdgeList = std::vector<std::pair<NodeId, NodeId>>;
+
+/**
+ * Non-owning view of a graph in compressed sparse row form.
+ * The neighbors of node u are neighbors[offsets[u] .. offsets[u + 1]).
+ */
+class CSRView {
+public:
+  // Contiguous neighbor range of a single node
+  class Neighbors {
+  public:
+    Neighbors(const NodeId *rowBegin, const NodeId *rowEnd)
+        : first(rowBegin), last(rowEnd) {}
+
+    const NodeId *begin() const { return first; }
+    const NodeId *end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+    NodeId operator[](const size_t i) const { return first[i]; }
+
+  private:
+    const NodeId *first;
+    const NodeId *last;
+  };
+
+  CSRView() = default;
+  CSRView(const std::uint64_t *rowOffsets, const NodeId *adjacency,
+          const size_t nodeCount)
+      : offsets(rowOffsets), neighbors(adjacency), nodes(nodeCount) {}
+
+  size_t size() const { return nodes; }
+  bool empty() const { return nodes == 0; }
+
+  // Number of stored (directed) adjacency entries
+  size_t entries() const {
+    return nodes == 0 ? 0 : static_cast<size_t>(offsets[nodes]);
+  }
+
+  size_t degree(const size_t u) const {
+    return static_cast<size_t>(offsets[u + 1] - offsets[u]);
+  }
+
+  Neighbors operator[](const size_t u) const {
+    return {neighbors + offsets[u], neighbors + offsets[u + 1]};
+  }
+
+  const std::uint64_t *offsetData() const { return offsets; }
+  const NodeId *neighborData() const { return neighbors; }
+
+private:
+  const std::uint64_t *offsets = nullptr;
+  const NodeId *neighbors = nullptr;
+  size_t nodes = 0;
+};
+
+/**
+ * Owning compressed sparse row graph. One offsets array of n + 1 entries and
+ * one flat neighbor array replace the per-node vectors of an adjacency list.
+ * The arrays may also live in external storage, e.g. a mapped file, that the
+ * graph keeps alive (see adopt()).
+ */
+class CSRGraph {
+public:
+  CSRGraph() : offsets(1, 0) {}
+
+  // Converts a nested adjacency list, keeping the neighbor order of each node
+  explicit CSRGraph(const std::vector<std::vector<unsigned long long>> &adj)
+      : offsets(1, 0) {
+    checkNodeCount(adj.size());
+    offsets.reserve(adj.size() + 1);
+    size_t total = 0;
+    for (const auto &row : adj) {
+      total += row.size();
+      offsets.push_back(total);
+    }
+    neighbors.reserve(total);
+    for (const auto &row : adj) {
+      for (const unsigned long long v : row) {
+        if (v >= adj.size()) {
+          throw std::out_of_range("neighbor id out of range");
+        }
+        neighbors.push_back(static_cast<NodeId>(v));
+      }
+    }
+  }
+
+  /**
+   * Builds the graph from a list of undirected edges. Every edge {u, v} is
+   * stored in the rows of both u and v, in the order the edges are given.
+   * Self-loops are stored once.
+   */
+  static CSRGraph fromEdges(const size_t n, const EdgeList &edges) {
+    checkNodeCount(n);
+    CSRGraph graph;
+    graph.offsets.assign(n + 1, 0);
+
+    // count degrees, shifted by one so the prefix sum yields row starts
+    for (const auto &edge : edges) {
+      if (edge.first >= n || edge.second >= n) {
+        throw std::out_of_range("edge endpoint out of range");
+      }
+      ++graph.offsets[edge.first + 1];
+      if (edge.first != edge.second) {
+        ++graph.offsets[edge.second + 1];
+      }
+    }
+    for (size_t u = 0; u < n; ++u) {
+      graph.offsets[u + 1] += graph.offsets[u];
+    }
+
+    graph.neighbors.resize(static_cast<size_t>(graph.offsets[n]));
+    std::vector<std::uint64_t> cursor(graph.offsets.begin(),
+                                      graph.offsets.end() - 1);
+    for (const auto &edge : edges) {
+      graph.neighbors[static_cast<size_t>(cursor[edge.first]++)] =
+          edge.second;
+      if (edge.first != edge.second) {
+        graph.neighbors[static_cast<size_t>(cursor[edge.second]++)] =
+            edge.first;
+      }
+    }
+    return graph;
+  }
+
+  /**
+   * Takes over ready-made rows: the neighbors of node u are
+   * neighbors[offsets[u] .. offsets[u + 1]). Lets generators that know the
+   * exact degrees fill the arrays in place.
+   */
+  static CSRGraph fromRows(std::vector<std::uint64_t> offsets,
+                           std::vector<NodeId> neighbors) {
+    if (offsets.empty() || offsets.front() != 0 ||
+        offsets.back() != neighbors.size()) {
+      throw std::invalid_argument("offsets do not match the neighbors");
+    }
+    const size_t n = offsets.size() - 1;
+    checkNodeCount(n);
+    for (size_t u = 0; u < n; ++u) {
+      if (offsets[u] > offsets[u + 1]) {
+        throw std::invalid_argument("offsets must not decrease");
+      }
+    }
+    for (const NodeId v : neighbors) {
+      if (v >= n) {
+        throw std::out_of_range("neighbor id out of range");
+      }
+    }
+    CSRGraph graph;
+    graph.offsets = std::move(offsets);
+    graph.neighbors = std::move(neighbors);
+    return graph;
+  }
+
+  /**
+   * Uses rows stored elsewhere without copying them: the neighbors of node u
+   * are neighbors[offsets[u] .. offsets[u + 1]), n = nodeCount. Only the
+   * ends of the offsets are checked. storage owns the arrays; copies of the
+   * graph share it.
+   */
+  static CSRGraph adopt(std::shared_ptr<const void> storage,
+                        const std::uint64_t *offsets, const NodeId *neighbors,
+                        const size_t nodeCount, const size_t entryCount) {
+    checkNodeCount(nodeCount);
+    if (!storage) {
+      throw std::invalid_argument("adopted rows need an owner");
+    }
+    if (offsets[0] != 0 || offsets[nodeCount] != entryCount) {
+      throw std::invalid_argument("offsets do not match the neighbors");
+    }
+    CSRGraph graph;
+    graph.external = std::move(storage);
+    graph.externalView = CSRView(offsets, neighbors, nodeCount);
+    return graph;
+  }
+
+  size_t size() const { return view().size(); }
+  bool empty() const { return size() == 0; }
+  size_t entries() const { return view().entries(); }
+  size_t degree(const size_t u) const { return view().degree(u); }
+  CSRView::Neighbors operator[](const size_t u) const { return view()[u]; }
+
+  CSRView view() const {
+    if (external) {
+      return externalView;
+    }
+    return {offsets.data(), neighbors.data(), offsets.size() - 1};
+  }
+
+  // Only lvalues convert, so a view can never outlive a temporary graph
+  operator CSRView() const & { return view(); }
+  operator CSRView() const && = delete;
+
+  void clear() {
+    offsets.assign(1, 0);
+    offsets.shrink_to_fit();
+    neighbors.clear();
+    neighbors.shrink_to_fit();
+    external.reset();
+    externalView = CSRView();
+  }
+
+private:
+  std::vector<std::uint64_t> offsets;
+  std::vector<NodeId> neighbors;
+  std::shared_ptr<const void> external; // set if the rows live elsewhere
+  CSRView externalView;
+
+  static void checkNodeCount(const size_t n) {
+    if (n > std::numeric_limits<NodeId>::max()) {
+      throw std::length_error("graph has too many nodes for 32-bit ids");
+    }
+  }
+};
+
+#endif // CSRGRAPH_H_INCLUDED
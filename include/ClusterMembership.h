@@ -0,0 +1,137 @@
+#ifndef CLUSTERMEMBERSHIP_H_INCLUDED
+#define CLUSTERMEMBERSHIP_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "CSRGraph.h"
+
+// Clusters are numbered 0 .. clusters() - 1
+using ClusterId = std::uint32_t;
+
+/**
+ * Overlapping assignment of nodes to clusters, stored in both directions in
+ * compressed sparse row form: the clusters of every node and the nodes of
+ * every cluster, each in increasing order.
+ */
+class ClusterMembership {
+public:
+  // Contiguous range of node or cluster ids
+  class Ids {
+  public:
+    Ids(const std::uint32_t *rowBegin, const std::uint32_t *rowEnd)
+        : first(rowBegin), last(rowEnd) {}
+
+    const std::uint32_t *begin() const { return first; }
+    const std::uint32_t *end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+    std::uint32_t operator[](const size_t i) const { return first[i]; }
+
+  private:
+    const std::uint32_t *first;
+    const std::uint32_t *last;
+  };
+
+  ClusterMembership() : nodeOffsets(1, 0), clusterOffsets(1, 0) {}
+
+  // clustersOfNode[u] lists the clusters of node u in increasing order, all
+  // below clusterCount
+  ClusterMembership(const std::vector<std::vector<ClusterId>> &clustersOfNode,
+                    const size_t clusterCount)
+      : nodeOffsets(1, 0), clusterOffsets(clusterCount + 1, 0) {
+    if (clusterCount > std::numeric_limits<ClusterId>::max()) {
+      throw std::length_error("too many clusters for 32-bit ids");
+    }
+    nodeOffsets.reserve(clustersOfNode.size() + 1);
+    size_t total = 0;
+    for (const auto &row : clustersOfNode) {
+      total += row.size();
+      nodeOffsets.push_back(total);
+    }
+
+    // Node -> clusters, counting the cluster sizes on the way
+    nodeClusters.reserve(total);
+    for (const auto &row : clustersOfNode) {
+      for (const ClusterId c : row) {
+        if (c >= clusterCount) {
+          throw std::out_of_range("cluster id out of range");
+        }
+        nodeClusters.push_back(c);
+        ++clusterOffsets[c + 1];
+      }
+    }
+
+    // Cluster -> nodes; visiting the nodes in order keeps every row sorted
+    for (size_t c = 0; c < clusterCount; ++c) {
+      clusterOffsets[c + 1] += clusterOffsets[c];
+    }
+    clusterNodes.resize(total);
+    std::vector<std::uint64_t> cursor(clusterOffsets.begin(),
+                                      clusterOffsets.end() - 1);
+    for (size_t u = 0; u < clustersOfNode.size(); ++u) {
+      for (const ClusterId c : clustersOfNode[u]) {
+        clusterNodes[static_cast<size_t>(cursor[c]++)] =
+            static_cast<NodeId>(u);
+      }
+    }
+  }
+
+  // Membership of the given clusters, each a list of node ids below
+  // nodeCount; repeated nodes count once
+  template <class Id>
+  static ClusterMembership
+  fromClusters(const std::vector<std::vector<Id>> &nodesOfCluster,
+               const size_t nodeCount) {
+    std::vector<std::vector<ClusterId>> clustersOfNode(nodeCount);
+    for (size_t c = 0; c < nodesOfCluster.size(); c++) {
+      for (const Id u : nodesOfCluster[c]) {
+        if (u >= nodeCount) {
+          throw std::out_of_range("cluster node out of range");
+        }
+        std::vector<ClusterId> &row = clustersOfNode[static_cast<size_t>(u)];
+        if (row.empty() || row.back() != c) {
+          row.push_back(static_cast<ClusterId>(c));
+        }
+      }
+    }
+    return ClusterMembership(clustersOfNode, nodesOfCluster.size());
+  }
+
+  size_t nodes() const { return nodeOffsets.size() - 1; }
+  size_t clusters() const { return clusterOffsets.size() - 1; }
+
+  // Number of (node, cluster) pairs
+  size_t entries() const { return nodeClusters.size(); }
+
+  Ids clustersOf(const size_t u) const {
+    return {nodeClusters.data() + nodeOffsets[u],
+            nodeClusters.data() + nodeOffsets[u + 1]};
+  }
+
+  Ids nodesOf(const size_t c) const {
+    return {clusterNodes.data() + clusterOffsets[c],
+            clusterNodes.data() + clusterOffsets[c + 1]};
+  }
+
+  // The cluster -> nodes direction follows from the other one
+  bool operator==(const ClusterMembership &other) const {
+    return clusters() == other.clusters() &&
+           nodeOffsets == other.nodeOffsets &&
+           nodeClusters == other.nodeClusters;
+  }
+  bool operator!=(const ClusterMembership &other) const {
+    return !(*this == other);
+  }
+
+private:
+  std::vector<std::uint64_t> nodeOffsets;
+  std::vector<ClusterId> nodeClusters;
+  std::vector<std::uint64_t> clusterOffsets;
+  std::vector<NodeId> clusterNodes;
+};
+
+#endif // CLUSTERMEMBERSHIP_H_INCLUDED
@@ -4,16 +4,19 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <map>
 #include <vector>
 
 #include "Graph.h"
 #include "RandomGenerator.h"
+#include "ThreadPool.h"
 
-inline bool contains1(const std::vector<unsigned long long> &g,
+inline bool contains1(const CSRView::Neighbors &g,
                       const unsigned long long n) {
-  return std::any_of(g.begin(), g.end(), [&n](const unsigned long long x) {
-    return x == static_cast<unsigned long long>(n);
+  return std::any_of(g.begin(), g.end(), [&n](const NodeId x) {
+    return static_cast<unsigned long long>(x) == n;
   });
 }
 
@@ -31,9 +34,59 @@ private:
                 // (there is an overlap of size overlaps[n-1] between n
                 // clusters)
   RandomGenerator rng;
+  ThreadPool *pool; // generates the blocks in parallel if set
+
+  // Nodes that are in the same set of clusters. Every pair of nodes lies in
+  // exactly one block of two groups (or of one group with itself).
+  struct NodeGroup {
+    std::vector<size_t> clusters; // increasing
+    std::vector<NodeId> nodes;
+  };
+
+  // Edges of the block of groups a and b, each node pair with probability p
+  // if the groups share a cluster and q otherwise
+  template <class Stream>
+  void generateBlock(const NodeGroup &a, const NodeGroup &b, Stream &stream,
+                     EdgeList &edges) const {
+    const bool related = std::find_first_of(a.clusters.begin(),
+                                            a.clusters.end(),
+                                            b.clusters.begin(),
+                                            b.clusters.end()) !=
+                         a.clusters.end();
+    const double prob = related ? intraProb : interProb;
+    if (&a != &b) {
+      const std::uint64_t width = b.nodes.size();
+      bernoulliIndices(stream, a.nodes.size() * width, prob,
+                       [&](const std::uint64_t i) {
+                         edges.emplace_back(a.nodes[i / width],
+                                            b.nodes[i % width]);
+                       });
+      return;
+    }
+    bernoulliPairs(stream, a.nodes.size(), prob,
+                   [&](const std::uint64_t w, const std::uint64_t v) {
+                     edges.emplace_back(a.nodes[w], a.nodes[v]);
+                   });
+  }
 
-  bool coinFlip(const double probability) {
-    return (rng.getRandomDouble(0.0, 100.0) / 100.0) < probability;
+  // Groups the nodes by the set of clusters they are in
+  std::vector<NodeGroup> groupNodes(const size_t nodeCount) const {
+    std::vector<std::vector<size_t>> clustersOf(nodeCount);
+    for (size_t c = 0; c < clusters.size(); c++) {
+      for (const unsigned long long u : clusters[c]) {
+        clustersOf[u].push_back(c);
+      }
+    }
+    std::map<std::vector<size_t>, size_t> index;
+    std::vector<NodeGroup> groups;
+    for (size_t u = 0; u < nodeCount; u++) {
+      const auto [it, added] = index.emplace(clustersOf[u], groups.size());
+      if (added) {
+        groups.push_back({clustersOf[u], {}});
+      }
+      groups[it->second].nodes.push_back(static_cast<NodeId>(u));
+    }
+    return groups;
   }
 
   // n Choose r
@@ -105,11 +158,13 @@ private:
 
 public:
   ClusteredGraph(const size_t numNodes,
-                 const std::vector<unsigned long long> &overlap)
+                 const std::vector<unsigned long long> &overlap,
+                 ThreadPool *threadPool = nullptr)
       : Graph(), n(numNodes), clusterNr(overlap.size()),
         p(2.5 * pow(log2(static_cast<double>(n)) / static_cast<double>(n),
                     1 / static_cast<double>(4))),
-        q(p / 150), intraProb(p), interProb(q), overlaps(overlap) {
+        q(p / 150), intraProb(p), interProb(q), overlaps(overlap),
+        pool(threadPool) {
     if (intraProb > 1) {
       intraProb = 1;
       interProb = static_cast<float>(1) / 150;
@@ -117,6 +172,8 @@ public:
     printProbabilities();
   }
 
+  void setThreadPool(ThreadPool *threadPool) override { pool = threadPool; }
+
   void generateGraph() override {
 
     unsigned long long nExclusive = n;
@@ -139,52 +196,48 @@ public:
       uniqueNodes += C(overlaps.size(), i + 1) * overlaps[i];
     }
 
-    adjList.resize(uniqueNodes);
-
     clusters.resize(clusterNr);
 
-    std::vector<std::vector<bool>>
-        connected; // this stores nodes we have connected already, so that we do
-                   // not connect nodes in the overlap > 1 time
-    connected.resize(uniqueNodes, std::vector<bool>(uniqueNodes));
-
     addNodes(clusters, overlaps);
 
-    // connecting clusters internally
-
-    for (auto &cluster : clusters) {
-      for (size_t j = 0; j < cluster.size(); j++) {
-        for (size_t m = j + 1; m < cluster.size(); m++) {
-          if (!connected[cluster[m]][cluster[j]]) {
-            connected[cluster[j]][cluster[m]] = true;
-            connected[cluster[m]][cluster[j]] = true;
-            if (coinFlip(intraProb)) {
-              adjList[cluster[j]].push_back(cluster[m]);
-              adjList[cluster[m]].push_back(cluster[j]);
-            }
-          }
-        }
+    // Every pair of distinct nodes is connected with probability p if they
+    // share a cluster and q otherwise, once even if they share several.
+    // Each block of node pairs draws from its own stream, so the blocks can
+    // be generated in any order.
+    const std::vector<NodeGroup> groups = groupNodes(uniqueNodes);
+    std::vector<std::pair<size_t, size_t>> blocks;
+    for (size_t a = 0; a < groups.size(); a++) {
+      for (size_t b = a; b < groups.size(); b++) {
+        blocks.emplace_back(a, b);
       }
     }
-
-    // connecting clusters externally as pairs
-
-    for (size_t i = 0; i < clusters.size(); i++) {
-      for (size_t j = i + 1; j < clusters.size(); j++) {
-        for (size_t x = 0; x < clusters[i].size(); x++) {
-          for (size_t y = 0; y < clusters[j].size(); y++) {
-            if (!connected[clusters[j][y]][clusters[i][x]]) {
-              connected[clusters[i][x]][clusters[j][y]] = true;
-              connected[clusters[j][y]][clusters[i][x]] = true;
-              if (coinFlip(interProb)) {
-                adjList[clusters[i][x]].push_back(clusters[j][y]);
-                adjList[clusters[j][y]].push_back(clusters[i][x]);
-              }
-            }
-          }
-        }
+    const std::uint64_t seed = rng.getRandomUll(0, ~0ULL);
+    std::vector<EdgeList> blockEdges(blocks.size());
+    auto generate = [&](const size_t i) {
+      std::uint64_t state = seed ^ (i * 0xd1b54a32d192ed03ULL);
+      SequentialStream stream(splitMix64(state));
+      generateBlock(groups[blocks[i].first], groups[blocks[i].second], stream,
+                    blockEdges[i]);
+    };
+    if (pool != nullptr) {
+      pool->parallelFor(blocks.size(), generate);
+    } else {
+      for (size_t i = 0; i < blocks.size(); i++) {
+        generate(i);
       }
     }
+
+    EdgeList edges;
+    size_t total = 0;
+    for (const EdgeList &block : blockEdges) {
+      total += block.size();
+    }
+    edges.reserve(total);
+    for (const EdgeList &block : blockEdges) {
+      edges.insert(edges.end(), block.begin(), block.end());
+    }
+
+    adjList = CSRGraph::fromEdges(uniqueNodes, edges);
   }
 
   void printMatrix() const {
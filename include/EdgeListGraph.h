@@ -0,0 +1,226 @@
+#ifndef EDGELISTGRAPH_H_INCLUDED
+#define EDGELISTGRAPH_H_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Graph.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+/**
+ * Graph read from an edge list file (SNAP style): one edge "u v" per line,
+ * separated by spaces or tabs, further columns ignored, lines starting with
+ * '#' or '%' are comments. Node ids may be sparse and up to 64 bits wide;
+ * they are renumbered densely in increasing order. The graph is made
+ * undirected, self-loops and repeated edges are dropped. There is no truth
+ * to write for such a graph.
+ */
+class EdgeListGraph final : public Graph {
+public:
+  explicit EdgeListGraph(std::string filename, ThreadPool *threadPool = nullptr)
+      : path(std::move(filename)), pool(threadPool) {}
+
+  void setThreadPool(ThreadPool *threadPool) override { pool = threadPool; }
+
+  void generateGraph() override {
+    ThreadPool ownPool(1);
+    ThreadPool &workers = pool != nullptr ? *pool : ownPool;
+    const MappedFile file(path);
+
+    // Parse chunks of whole lines in parallel
+    const std::vector<size_t> bounds = chunkBounds(file, workers.size());
+    std::vector<RawEdges> parsed(bounds.size() - 1);
+    workers.parallelFor(parsed.size(), [&](const size_t i) {
+      parseChunk(file.data(), bounds[i], bounds[i + 1], parsed[i]);
+    });
+
+    // Dense ids, then every edge once as (smaller, larger) packed into 64 bits
+    const DenseIds ids(parsed, workers);
+    if (ids.size() > std::numeric_limits<NodeId>::max()) {
+      throw std::length_error("graph has too many nodes for 32-bit ids");
+    }
+    std::vector<size_t> firstEdge(parsed.size() + 1, 0);
+    for (size_t i = 0; i < parsed.size(); i++) {
+      firstEdge[i + 1] = firstEdge[i] + parsed[i].size();
+    }
+    std::vector<std::uint64_t> edges(firstEdge.back());
+    workers.parallelFor(parsed.size(), [&](const size_t i) {
+      size_t out = firstEdge[i];
+      for (const auto &[a, b] : parsed[i]) {
+        const std::uint64_t u = ids[a];
+        const std::uint64_t v = ids[b];
+        edges[out++] = u < v ? (u << 32 | v) : (v << 32 | u);
+      }
+      parsed[i] = {};
+    });
+    parallelSort(workers, edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    // Rows in increasing neighbor order: a node receives its smaller
+    // neighbors from earlier pairs, then its larger ones from its own
+    const size_t n = ids.size();
+    std::vector<std::uint64_t> offsets(n + 1, 0);
+    for (const std::uint64_t edge : edges) {
+      if ((edge >> 32) != (edge & 0xffffffffULL)) {
+        ++offsets[(edge >> 32) + 1];
+        ++offsets[(edge & 0xffffffffULL) + 1];
+      }
+    }
+    for (size_t u = 0; u < n; u++) {
+      offsets[u + 1] += offsets[u];
+    }
+    std::vector<NodeId> neighbors(static_cast<size_t>(offsets[n]));
+    std::vector<std::uint64_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (const std::uint64_t edge : edges) {
+      const auto u = static_cast<NodeId>(edge >> 32);
+      const auto v = static_cast<NodeId>(edge & 0xffffffffULL);
+      if (u != v) {
+        neighbors[static_cast<size_t>(cursor[u]++)] = v;
+        neighbors[static_cast<size_t>(cursor[v]++)] = u;
+      }
+    }
+    adjList = CSRGraph::fromRows(std::move(offsets), std::move(neighbors));
+  }
+
+private:
+  std::string path;
+  ThreadPool *pool; // parses and sorts in parallel if set
+
+  // Edges of a chunk of the file, with the ids as written there
+  using RawEdges = std::vector<std::pair<std::uint64_t, std::uint64_t>>;
+
+  static constexpr size_t MIN_CHUNK_BYTES = 1 << 20;
+
+  // Offsets that cut the file into about 4 chunks per thread, each ending
+  // after a newline (or at the end of the file)
+  static std::vector<size_t> chunkBounds(const MappedFile &file,
+                                         const size_t threads) {
+    const size_t size = file.size();
+    const size_t chunks = std::max<size_t>(
+        1, std::min(4 * threads, size / MIN_CHUNK_BYTES));
+    std::vector<size_t> bounds{0};
+    for (size_t i = 1; i < chunks; i++) {
+      size_t at = std::max(bounds.back(), size * i / chunks);
+      while (at < size && file.data()[at - 1] != '\n') {
+        at++;
+      }
+      bounds.push_back(at);
+    }
+    bounds.push_back(size);
+    return bounds;
+  }
+
+  static bool isBlank(const char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+  }
+
+  // Reads the digits at text[at..end), throws if there are none
+  static std::uint64_t parseId(const char *text, size_t &at,
+                               const size_t end) {
+    if (at == end || text[at] < '0' || text[at] > '9') {
+      throw std::runtime_error("malformed edge at byte " + std::to_string(at));
+    }
+    std::uint64_t value = 0;
+    for (; at < end && text[at] >= '0' && text[at] <= '9'; at++) {
+      value = value * 10 + static_cast<std::uint64_t>(text[at] - '0');
+    }
+    return value;
+  }
+
+  static void parseChunk(const char *text, size_t at, const size_t end,
+                         RawEdges &out) {
+    while (at < end) {
+      while (at < end && isBlank(text[at])) {
+        at++;
+      }
+      if (at < end && text[at] != '\n' && text[at] != '#' &&
+          text[at] != '%') {
+        const std::uint64_t u = parseId(text, at, end);
+        while (at < end && isBlank(text[at])) {
+          at++;
+        }
+        out.emplace_back(u, parseId(text, at, end));
+      }
+      while (at < end && text[at] != '\n') {
+        at++; // rest of the line
+      }
+      at++;
+    }
+  }
+
+  // Maps the ids of the file to 0 .. size() - 1, keeping their order. Ids
+  // up to a few times the number of edges are looked up in a table, larger
+  // ones are sorted and found by binary search.
+  class DenseIds {
+  public:
+    DenseIds(const std::vector<RawEdges> &parsed, ThreadPool &workers) {
+      size_t edgeCount = 0;
+      std::uint64_t maxId = 0;
+      for (const auto &chunk : parsed) {
+        edgeCount += chunk.size();
+        for (const auto &[a, b] : chunk) {
+          maxId = std::max({maxId, a, b});
+        }
+      }
+      if (edgeCount == 0) {
+        return;
+      }
+      if (maxId <= 4 * static_cast<std::uint64_t>(edgeCount) + (1 << 20)) {
+        table.assign(static_cast<size_t>(maxId) + 1, UNUSED);
+        for (const auto &chunk : parsed) {
+          for (const auto &[a, b] : chunk) {
+            table[static_cast<size_t>(a)] = 0;
+            table[static_cast<size_t>(b)] = 0;
+          }
+        }
+        for (NodeId &id : table) {
+          if (id != UNUSED) {
+            if (count == UNUSED) {
+              throw std::length_error(
+                  "graph has too many nodes for 32-bit ids");
+            }
+            id = static_cast<NodeId>(count++);
+          }
+        }
+        return;
+      }
+      sorted.reserve(2 * edgeCount);
+      for (const auto &chunk : parsed) {
+        for (const auto &[a, b] : chunk) {
+          sorted.push_back(a);
+          sorted.push_back(b);
+        }
+      }
+      parallelSort(workers, sorted.begin(), sorted.end());
+      sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+      sorted.shrink_to_fit();
+      count = sorted.size();
+    }
+
+    size_t size() const { return static_cast<size_t>(count); }
+
+    std::uint64_t operator[](const std::uint64_t id) const {
+      if (!table.empty()) {
+        return table[static_cast<size_t>(id)];
+      }
+      return static_cast<std::uint64_t>(
+          std::lower_bound(sorted.begin(), sorted.end(), id) - sorted.begin());
+    }
+
+  private:
+    static constexpr NodeId UNUSED = std::numeric_limits<NodeId>::max();
+
+    std::uint64_t count = 0;
+    std::vector<NodeId> table;         // dense id of every id up to the max
+    std::vector<std::uint64_t> sorted; // or all ids in increasing order
+  };
+};
+
+#endif // EDGELISTGRAPH_H_INCLUDED
@@ -0,0 +1,23 @@
+#ifndef EGOGRAPHPARAMS_H_INCLUDED
+#define EGOGRAPHPARAMS_H_INCLUDED
+
+#include <cstddef>
+
+// Shape of the generated ego networks. The defaults give the ego graphs of
+// the original experiment: 4-6 cliques, every pair of them overlapping and
+// linked by a few random edges.
+struct EgoGraphParams {
+  size_t minClusters = 4;
+  size_t maxClusters = 6;
+  int clusterMeanSize = 125; // nodes of a cluster besides shared ones, normal
+  int clusterStdDev = 25;
+  int minOverlap = 0; // nodes shared by two overlapping clusters, uniform
+  int maxOverlap = 10;
+  int minInterEdges = 10; // random edges between two linked clusters, uniform
+  int maxInterEdges = 20;
+  // Probability that two clusters overlap and are linked; lower it to keep
+  // graphs with thousands of clusters sparse
+  double pairProbability = 1.0;
+};
+
+#endif // EGOGRAPHPARAMS_H_INCLUDED
@@ -0,0 +1,631 @@
+#ifndef EVALUATION_H_INCLUDED
+#define EVALUATION_H_INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ClusterMembership.h"
+#include "ThreadPool.h"
+
+// Row without a column in minimumCostAssignment()
+constexpr size_t UNMATCHED = std::numeric_limits<size_t>::max();
+
+/**
+ * Assigns the rows of a cost matrix to distinct columns with the least total
+ * cost (Hungarian algorithm with potentials, O(r^2 c) for r <= c rows and
+ * columns). Returns the column of every row; with more rows than columns,
+ * the rows left over are UNMATCHED.
+ */
+inline std::vector<size_t>
+minimumCostAssignment(const std::vector<std::vector<double>> &cost) {
+  const size_t rows = cost.size();
+  const size_t cols = rows == 0 ? 0 : cost[0].size();
+  std::vector<size_t> assignment(rows, UNMATCHED);
+  if (rows == 0 || cols == 0) {
+    return assignment;
+  }
+  if (rows > cols) {
+    std::vector<std::vector<double>> transposed(cols,
+                                                std::vector<double>(rows));
+    for (size_t i = 0; i < rows; i++) {
+      for (size_t j = 0; j < cols; j++) {
+        transposed[j][i] = cost[i][j];
+      }
+    }
+    const std::vector<size_t> rowOfColumn = minimumCostAssignment(transposed);
+    for (size_t j = 0; j < cols; j++) {
+      assignment[rowOfColumn[j]] = j;
+    }
+    return assignment;
+  }
+
+  // 1-based; row[j] is the row assigned to column j, column 0 is a sentinel
+  const double infinity = std::numeric_limits<double>::infinity();
+  std::vector<double> rowPotential(rows + 1, 0.0);
+  std::vector<double> colPotential(cols + 1, 0.0);
+  std::vector<size_t> row(cols + 1, 0);
+  std::vector<size_t> previous(cols + 1, 0);
+  std::vector<double> slack(cols + 1);
+  std::vector<char> visited(cols + 1);
+  for (size_t i = 1; i <= rows; i++) {
+    // Grow an alternating path from row i until it reaches a free column
+    row[0] = i;
+    size_t j0 = 0;
+    std::fill(slack.begin(), slack.end(), infinity);
+    std::fill(visited.begin(), visited.end(), 0);
+    do {
+      visited[j0] = 1;
+      const size_t i0 = row[j0];
+      double delta = infinity;
+      size_t j1 = 0;
+      for (size_t j = 1; j <= cols; j++) {
+        if (visited[j]) {
+          continue;
+        }
+        const double reduced =
+            cost[i0 - 1][j - 1] - rowPotential[i0] - colPotential[j];
+        if (reduced < slack[j]) {
+          slack[j] = reduced;
+          previous[j] = j0;
+        }
+        if (slack[j] < delta) {
+          delta = slack[j];
+          j1 = j;
+        }
+      }
+      for (size_t j = 0; j <= cols; j++) {
+        if (visited[j]) {
+          rowPotential[row[j]] += delta;
+          colPotential[j] -= delta;
+        } else {
+          slack[j] -= delta;
+        }
+      }
+      j0 = j1;
+    } while (row[j0] != 0);
+
+    // Flip the path
+    do {
+      const size_t j1 = previous[j0];
+      row[j0] = row[j1];
+      j0 = j1;
+    } while (j0 != 0);
+  }
+  for (size_t j = 1; j <= cols; j++) {
+    if (row[j] != 0) {
+      assignment[row[j] - 1] = j - 1;
+    }
+  }
+  return assignment;
+}
+
+// Mean and sample standard deviation of values added one by one
+struct RunningStat {
+  size_t count = 0;
+  double sum = 0;
+  double squares = 0;
+
+  void add(const double x) {
+    count++;
+    sum += x;
+    squares += x * x;
+  }
+
+  void merge(const RunningStat &other) {
+    count += other.count;
+    sum += other.sum;
+    squares += other.squares;
+  }
+
+  double mean() const {
+    return count == 0 ? 0.0 : sum / static_cast<double>(count);
+  }
+
+  double stddev() const {
+    if (count < 2) {
+      return 0.0;
+    }
+    const auto n = static_cast<double>(count);
+    return std::sqrt(std::max(0.0, (squares - sum * sum / n) / (n - 1)));
+  }
+};
+
+/**
+ * Comparison of one clustering with the ground truth. The clusters are
+ * matched one-to-one to truth clusters with the largest total Jaccard
+ * similarity, as compareToTruth.py does. Nodes of a cluster outside its
+ * match (all of them if it is unmatched) are extra; nodes of a truth cluster
+ * outside its match are missing.
+ */
+struct Evaluation {
+  size_t clusters = 0;
+  size_t truthClusters = 0;
+  std::vector<size_t> match; // truth cluster of every cluster, or UNMATCHED
+  double meanJaccard = 0;    // over the matched pairs
+  std::uint64_t extraNodes = 0;
+  std::uint64_t missingNodes = 0;
+  std::uint64_t clusterSize = 0; // summed over the clusters
+  std::uint64_t truthSize = 0;   // summed over the truth clusters
+  double precision = 0;          // 1 - extraNodes / clusterSize
+  double recall = 0;             // 1 - missingNodes / truthSize
+  double f1 = 0;
+  double onmi = 0; // overlapping NMI, 1 for identical clusterings
+
+  // [x]: nodes in exactly x clusters, and in exactly x truth clusters
+  std::vector<std::uint64_t> nodesIn;
+  std::vector<std::uint64_t> truthNodesIn;
+
+  // [x]: Jaccard similarity between the matches of a node's clusters and
+  // its truth clusters, over the nodes in x truth clusters. Nodes in
+  // neither are left out.
+  std::vector<RunningStat> nodeJaccard;
+
+  bool clusterCountMatches() const { return clusters == truthClusters; }
+};
+
+/**
+ * Overlapping normalized mutual information of two covers of n nodes, in
+ * the max-normalized form of McDaid, Greene and Hurley (2011). sizesX and
+ * sizesY are the cluster sizes, common[k * |Y| + l] = |X_k ∩ Y_l|.
+ */
+inline double overlappingNmi(const std::vector<std::uint64_t> &sizesX,
+                             const std::vector<std::uint64_t> &sizesY,
+                             const std::vector<std::uint64_t> &common,
+                             const std::uint64_t n) {
+  if (n == 0) {
+    return 0.0;
+  }
+  auto h = [n](const std::uint64_t count) {
+    const double p = static_cast<double>(count) / static_cast<double>(n);
+    return count == 0 ? 0.0 : -p * std::log2(p);
+  };
+  auto entropy = [&](const std::uint64_t size) {
+    return h(size) + h(n - size);
+  };
+
+  // H(X_k | Y) is the least H(X_k | Y_l) over the Y_l that carry information
+  // about X_k, or H(X_k) if none does
+  auto conditional = [&](const std::vector<std::uint64_t> &sizesA,
+                         const std::vector<std::uint64_t> &sizesB,
+                         const bool transposed) {
+    double total = 0;
+    for (size_t k = 0; k < sizesA.size(); k++) {
+      double best = entropy(sizesA[k]);
+      for (size_t l = 0; l < sizesB.size(); l++) {
+        const std::uint64_t d = transposed ? common[l * sizesA.size() + k]
+                                           : common[k * sizesB.size() + l];
+        const std::uint64_t c = sizesA[k] - d;
+        const std::uint64_t b = sizesB[l] - d;
+        const std::uint64_t a = n - b - c - d;
+        if (h(a) + h(d) >= h(b) + h(c)) {
+          best = std::min(best, h(a) + h(b) + h(c) + h(d) - entropy(sizesB[l]));
+        }
+      }
+      total += best;
+    }
+    return total;
+  };
+
+  double entropyX = 0;
+  for (const std::uint64_t size : sizesX) {
+    entropyX += entropy(size);
+  }
+  double entropyY = 0;
+  for (const std::uint64_t size : sizesY) {
+    entropyY += entropy(size);
+  }
+  const double norm = std::max(entropyX, entropyY);
+  if (norm <= 0) {
+    return 0.0;
+  }
+  const double mutual = 0.5 * (entropyX - conditional(sizesX, sizesY, false) +
+                               entropyY - conditional(sizesY, sizesX, true));
+  return mutual / norm;
+}
+
+// Scores the clusters of `found` against those of `truth`; nodes beyond
+// either's node count are in none of its clusters
+inline Evaluation evaluate(const ClusterMembership &found,
+                           const ClusterMembership &truth) {
+  Evaluation e;
+  e.clusters = found.clusters();
+  e.truthClusters = truth.clusters();
+  const size_t n = std::max(found.nodes(), truth.nodes());
+  const size_t K = e.clusters;
+  const size_t L = e.truthClusters;
+
+  std::vector<std::uint64_t> sizes(K);
+  std::vector<std::uint64_t> truthSizes(L);
+  for (size_t k = 0; k < K; k++) {
+    sizes[k] = found.nodesOf(k).size();
+    e.clusterSize += sizes[k];
+  }
+  for (size_t l = 0; l < L; l++) {
+    truthSizes[l] = truth.nodesOf(l).size();
+    e.truthSize += truthSizes[l];
+  }
+
+  auto clustersOf = [](const ClusterMembership &m, const size_t u) {
+    return u < m.nodes() ? m.clustersOf(u) : ClusterMembership::Ids(nullptr,
+                                                                     nullptr);
+  };
+  std::vector<std::uint64_t> common(K * L, 0);
+  for (size_t u = 0; u < n; u++) {
+    for (const ClusterId k : clustersOf(found, u)) {
+      for (const ClusterId l : clustersOf(truth, u)) {
+        common[k * L + l]++;
+      }
+    }
+  }
+
+  // Jaccard matching
+  auto jaccard = [&](const size_t k, const size_t l) {
+    const std::uint64_t both = common[k * L + l];
+    const std::uint64_t either = sizes[k] + truthSizes[l] - both;
+    return either == 0 ? 0.0
+                       : static_cast<double>(both) /
+                             static_cast<double>(either);
+  };
+  std::vector<std::vector<double>> cost(K, std::vector<double>(L));
+  for (size_t k = 0; k < K; k++) {
+    for (size_t l = 0; l < L; l++) {
+      cost[k][l] = -jaccard(k, l);
+    }
+  }
+  e.match = minimumCostAssignment(cost);
+  std::vector<size_t> matchOfTruth(L, UNMATCHED);
+  size_t pairs = 0;
+  double jaccardSum = 0;
+  e.extraNodes = e.clusterSize;
+  e.missingNodes = e.truthSize;
+  for (size_t k = 0; k < K; k++) {
+    const size_t l = e.match[k];
+    if (l == UNMATCHED) {
+      continue;
+    }
+    matchOfTruth[l] = k;
+    pairs++;
+    jaccardSum += jaccard(k, l);
+    e.extraNodes -= common[k * L + l];
+    e.missingNodes -= common[k * L + l];
+  }
+  e.meanJaccard = pairs == 0 ? 0.0 : jaccardSum / static_cast<double>(pairs);
+  auto share = [](const std::uint64_t part, const std::uint64_t whole) {
+    return whole == 0 ? 0.0
+                      : static_cast<double>(part) / static_cast<double>(whole);
+  };
+  e.precision = e.clusterSize == 0
+                    ? 0.0
+                    : 1.0 - share(e.extraNodes, e.clusterSize);
+  e.recall =
+      e.truthSize == 0 ? 0.0 : 1.0 - share(e.missingNodes, e.truthSize);
+  e.f1 = e.precision + e.recall == 0
+             ? 0.0
+             : 2 * e.precision * e.recall / (e.precision + e.recall);
+  e.onmi = overlappingNmi(sizes, truthSizes, common, n);
+
+  // Per node: cluster counts and the Jaccard similarity of its matched
+  // clusters (unmatched ones as ids L + k) with its truth clusters
+  std::vector<size_t> matched;
+  for (size_t u = 0; u < n; u++) {
+    const auto mine = clustersOf(found, u);
+    const auto theirs = clustersOf(truth, u);
+    const size_t x = theirs.size();
+    if (e.nodesIn.size() <= mine.size()) {
+      e.nodesIn.resize(mine.size() + 1, 0);
+    }
+    if (e.truthNodesIn.size() <= x) {
+      e.truthNodesIn.resize(x + 1, 0);
+    }
+    e.nodesIn[mine.size()]++;
+    e.truthNodesIn[x]++;
+    if (mine.empty() && theirs.empty()) {
+      continue;
+    }
+
+    matched.clear();
+    for (const ClusterId k : mine) {
+      matched.push_back(e.match[k] == UNMATCHED ? L + k : e.match[k]);
+    }
+    std::sort(matched.begin(), matched.end());
+    size_t both = 0;
+    for (size_t i = 0, j = 0; i < matched.size() && j < x;) {
+      if (matched[i] == theirs[j]) {
+        both++;
+        i++;
+        j++;
+      } else if (matched[i] < theirs[j]) {
+        i++;
+      } else {
+        j++;
+      }
+    }
+    if (e.nodeJaccard.size() <= x) {
+      e.nodeJaccard.resize(x + 1);
+    }
+    e.nodeJaccard[x].add(static_cast<double>(both) /
+                         static_cast<double>(matched.size() + x - both));
+  }
+  return e;
+}
+
+/**
+ * Aggregate of the evaluations of many runs, in the terms of
+ * compareToTruth.py and count_error.py. Node membership counts are only
+ * summed over the runs that found as many clusters as the truth has.
+ */
+class EvaluationSummary {
+public:
+  void add(const Evaluation &e) {
+    runs++;
+    extraNodes += e.extraNodes;
+    missingNodes += e.missingNodes;
+    truthSize += e.truthSize;
+    if (e.clusters > 0 && e.truthClusters > 0) {
+      jaccard.add(e.meanJaccard);
+    }
+    precision.add(e.precision);
+    recall.add(e.recall);
+    f1.add(e.f1);
+    onmi.add(e.onmi);
+    grow(nodeJaccard, e.nodeJaccard.size());
+    for (size_t x = 0; x < e.nodeJaccard.size(); x++) {
+      nodeJaccard[x].merge(e.nodeJaccard[x]);
+    }
+    if (!e.clusterCountMatches()) {
+      return;
+    }
+    matchingRuns++;
+    grow(nodesIn, e.nodesIn.size());
+    grow(truthNodesIn, e.truthNodesIn.size());
+    for (size_t x = 0; x < e.nodesIn.size(); x++) {
+      nodesIn[x] += e.nodesIn[x];
+    }
+    for (size_t x = 0; x < e.truthNodesIn.size(); x++) {
+      truthNodesIn[x] += e.truthNodesIn[x];
+    }
+  }
+
+  size_t size() const { return runs; }
+
+  void write(std::ostream &out) const {
+    out << "Runs: " << runs << "\n"
+        << "Correctly Clustered Runs: " << matchingRuns << "\n"
+        << "Total Extra Nodes: " << extraNodes << "\n"
+        << "Total Missing Nodes: " << missingNodes << "\n"
+        << "Total Truth Size: " << truthSize << "\n";
+    writeStat(out, "Jaccard", jaccard);
+    writeStat(out, "Precision", precision);
+    writeStat(out, "Recall", recall);
+    writeStat(out, "F1", f1);
+    writeStat(out, "ONMI", onmi);
+
+    out << "\nJaccard Index Statistics by Number of Clusters:\n"
+        << "Clusters Count | Mean Jaccard | Std Dev\n"
+        << std::string(60, '-') << "\n";
+    for (size_t x = 0; x < nodeJaccard.size(); x++) {
+      if (nodeJaccard[x].count > 0) {
+        out << x << " | " << nodeJaccard[x].mean() << " | "
+            << nodeJaccard[x].stddev() << "\n";
+      }
+    }
+
+    out << "\nOver the correctly clustered runs:\n";
+    for (size_t x = 1; x < std::max(nodesIn.size(), truthNodesIn.size());
+         x++) {
+      const std::uint64_t got = x < nodesIn.size() ? nodesIn[x] : 0;
+      const std::uint64_t expected =
+          x < truthNodesIn.size() ? truthNodesIn[x] : 0;
+      out << "Nodes in " << x << " clusters: " << got << " / " << expected;
+      if (expected > 0) {
+        out << " = "
+            << static_cast<double>(got) / static_cast<double>(expected);
+      }
+      out << "\n";
+    }
+    out << "Unused nodes: " << (nodesIn.empty() ? 0 : nodesIn[0]) << "\n";
+  }
+
+private:
+  size_t runs = 0;
+  size_t matchingRuns = 0; // with as many clusters as the truth
+  std::uint64_t extraNodes = 0;
+  std::uint64_t missingNodes = 0;
+  std::uint64_t truthSize = 0;
+  RunningStat jaccard; // mean Jaccard of the matched pairs, per run
+  RunningStat precision;
+  RunningStat recall;
+  RunningStat f1;
+  RunningStat onmi;
+  std::vector<RunningStat> nodeJaccard;
+  std::vector<std::uint64_t> nodesIn;
+  std::vector<std::uint64_t> truthNodesIn;
+
+  template <class T> static void grow(std::vector<T> &v, const size_t size) {
+    if (v.size() < size) {
+      v.resize(size);
+    }
+  }
+
+  static void writeStat(std::ostream &out, const char *name,
+                        const RunningStat &stat) {
+    out << name << " Average: " << stat.mean() << "\n"
+        << name << " Standard Deviation: " << stat.stddev() << "\n";
+  }
+};
+
+/**
+ * Writes the scores of every run as CSV rows. Runs read back from a file
+ * have no alpha and beta; NaN leaves those fields empty.
+ */
+class EvaluationWriter {
+public:
+  explicit EvaluationWriter(const std::string &filename)
+      : out(filename, std::ios::trunc) {
+    if (!out) {
+      throw std::runtime_error("cannot write '" + filename + "'");
+    }
+    out.precision(9);
+    out << "graph,run,alpha,beta,clusters,truth_clusters,mean_jaccard,"
+        << "precision,recall,f1,onmi,extra_nodes,missing_nodes,"
+        << "unused_nodes\n";
+  }
+
+  void write(const Evaluation &e, const int graph, const int run,
+             const double alpha, const double beta) {
+    out << graph << "," << run << ",";
+    if (!std::isnan(alpha)) {
+      out << alpha;
+    }
+    out << ",";
+    if (!std::isnan(beta)) {
+      out << beta;
+    }
+    out << "," << e.clusters << "," << e.truthClusters << ","
+        << e.meanJaccard << "," << e.precision << "," << e.recall << ","
+        << e.f1 << "," << e.onmi << "," << e.extraNodes << ","
+        << e.missingNodes << "," << (e.nodesIn.empty() ? 0 : e.nodesIn[0])
+        << "\n";
+  }
+
+private:
+  std::ofstream out;
+};
+
+// Clusters found in, or ground truth of, one run on one graph
+struct ClusteredRun {
+  static constexpr int EVERY_RUN = -1; // run of a truth shared by all runs
+
+  int graph = 0;
+  int run = 0;
+  size_t nodes = 0; // nodes of the graph, 0 if the file does not record it
+  std::vector<std::vector<NodeId>> clusters;
+};
+
+/**
+ * Reads a cluster or truth file written by main: a "graph run" line starts
+ * every run, and each "Cluster c: ..." line is followed by the line of that
+ * cluster's nodes. Truth files hold every graph once, started by a
+ * "graph nodes n" line; they are read as the truth of run EVERY_RUN.
+ */
+inline std::vector<ClusteredRun> readClusterFile(const std::string &filename) {
+  std::ifstream in(filename);
+  if (!in) {
+    throw std::runtime_error("cannot read '" + filename + "'");
+  }
+  std::vector<ClusteredRun> runs;
+  std::string line;
+  size_t lineNumber = 0;
+  auto malformed = [&]() {
+    return std::runtime_error("malformed line " + std::to_string(lineNumber) +
+                              " in '" + filename + "'");
+  };
+  while (std::getline(in, line)) {
+    lineNumber++;
+    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+      continue;
+    }
+    std::istringstream fields(line);
+    if (line.compare(line.find_first_not_of(" \t"), 7, "Cluster") == 0) {
+      if (runs.empty()) {
+        throw malformed();
+      }
+      std::string nodes;
+      std::getline(in, nodes);
+      lineNumber++;
+      std::istringstream ids(nodes);
+      std::vector<NodeId> cluster;
+      for (unsigned long long u; ids >> u;) {
+        cluster.push_back(static_cast<NodeId>(u));
+      }
+      if (!ids.eof()) {
+        throw malformed();
+      }
+      runs.back().clusters.push_back(std::move(cluster));
+      continue;
+    }
+    ClusteredRun run;
+    std::string second;
+    std::string rest;
+    if (!(fields >> run.graph >> second)) {
+      throw malformed();
+    }
+    std::istringstream runField(second);
+    const bool parsed = second == "nodes"
+                            ? static_cast<bool>(fields >> run.nodes)
+                            : (runField >> run.run) && runField.eof();
+    if (second == "nodes") {
+      run.run = ClusteredRun::EVERY_RUN;
+    }
+    if (!parsed || (fields >> rest)) {
+      throw malformed();
+    }
+    runs.push_back(std::move(run));
+  }
+  return runs;
+}
+
+// Node count of the graph of two runs: the one a file recorded, as the
+// runs evaluated during clustering use the graph's size. Files without it
+// give the highest node id in either run plus one, which leaves out trailing
+// nodes that are in no cluster.
+inline size_t nodeCount(const ClusteredRun &a, const ClusteredRun &b) {
+  size_t n = std::max(a.nodes, b.nodes);
+  for (const ClusteredRun *run : {&a, &b}) {
+    for (const auto &cluster : run->clusters) {
+      for (const NodeId u : cluster) {
+        n = std::max(n, static_cast<size_t>(u) + 1);
+      }
+    }
+  }
+  return n;
+}
+
+/**
+ * Evaluates every found run against the truth of the same graph and run, or
+ * else of the same graph and EVERY_RUN, in parallel on pool. The results
+ * are in the order of `found`.
+ */
+inline std::vector<Evaluation>
+evaluateRuns(const std::vector<ClusteredRun> &found,
+             const std::vector<ClusteredRun> &truth, ThreadPool &pool) {
+  std::map<std::pair<int, int>, const ClusteredRun *> truthOf;
+  for (const ClusteredRun &run : truth) {
+    truthOf[{run.graph, run.run}] = &run;
+  }
+  std::vector<const ClusteredRun *> pairs(found.size());
+  for (size_t r = 0; r < found.size(); r++) {
+    auto it = truthOf.find({found[r].graph, found[r].run});
+    if (it == truthOf.end()) {
+      it = truthOf.find({found[r].graph, ClusteredRun::EVERY_RUN});
+    }
+    if (it == truthOf.end()) {
+      throw std::runtime_error("no truth for graph " +
+                               std::to_string(found[r].graph) + ", run " +
+                               std::to_string(found[r].run));
+    }
+    pairs[r] = it->second;
+  }
+
+  std::vector<Evaluation> evaluations(found.size());
+  pool.parallelFor(found.size(), [&](const size_t r) {
+    const size_t n = nodeCount(found[r], *pairs[r]);
+    evaluations[r] =
+        evaluate(ClusterMembership::fromClusters(found[r].clusters, n),
+                 ClusterMembership::fromClusters(pairs[r]->clusters, n));
+  });
+  return evaluations;
+}
+
+#endif // EVALUATION_H_INCLUDED
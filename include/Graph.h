@@ -5,9 +5,21 @@
 #include <cstddef>
 #include <fstream>
 #include <iostream>
+#include <ostream>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "CSRGraph.h"
+
+class ThreadPool;
+
+// Adjacency and ground truth of one generated graph
+struct GeneratedGraph {
+  CSRGraph adjList;
+  std::vector<std::vector<unsigned long long>> clusters;
+};
+
 class Graph {
 public:
   Graph() = default;
@@ -15,20 +27,41 @@ public:
 
   virtual void generateGraph() = 0;
 
-  const std::vector<std::vector<unsigned long long>> &getAdjList() const {
-    return adjList;
+  // Pool the following generateGraph() calls run their parallel work on, for
+  // generators that have one
+  virtual void setThreadPool(ThreadPool * /*threadPool*/) {}
+
+  const CSRGraph &getAdjList() const { return adjList; }
+
+  // Ground truth clusters, empty if the graph has none
+  const std::vector<std::vector<unsigned long long>> &truthClusters() const {
+    return clusters;
   }
 
   void printGraph() const {
     for (size_t i = 0; i < adjList.size(); ++i) {
       std::cout << "Node " << i << " -> ";
-      for (const unsigned long long neighbor : adjList[i]) {
+      for (const NodeId neighbor : adjList[i]) {
         std::cout << neighbor << " ";
       }
       std::cout << std::endl;
     }
   }
 
+  // Writes the truth clusters, each as a "Cluster c:" line followed by the
+  // line of its nodes
+  static void
+  writeTruth(std::ostream &out,
+             const std::vector<std::vector<unsigned long long>> &truth) {
+    for (size_t i = 0; i < truth.size(); ++i) {
+      out << "Cluster " << i + 1 << ": \n";
+      for (const unsigned long long neighbor : truth[i]) {
+        out << neighbor << " ";
+      }
+      out << "\n";
+    }
+  }
+
   void appendTruthToFile(const std::string &filename) const {
     std::cout << "Writing truth to file '" << filename << "'!" << std::endl;
     std::ofstream f;
@@ -39,13 +72,7 @@ public:
                 << std::endl;
       return;
     }
-    for (size_t i = 0; i < clusters.size(); ++i) {
-      f << "Cluster " << i + 1 << ": " << std::endl;
-      for (const unsigned long long neighbor : clusters[i]) {
-        f << neighbor << " ";
-      }
-      f << std::endl;
-    }
+    writeTruth(f, clusters);
     f.close();
   }
 
@@ -54,9 +81,16 @@ public:
     clusters.clear();
   }
 
+  // Moves the adjacency and truth out, leaving the graph as deleteGraph()
+  // does, so the next one can be generated while this one is in use
+  GeneratedGraph release() {
+    GeneratedGraph graph{std::move(adjList), std::move(clusters)};
+    deleteGraph();
+    return graph;
+  }
+
 protected:
-  std::vector<std::vector<unsigned long long>>
-      adjList; // Adjacency list for the graph
+  CSRGraph adjList; // Adjacency of the graph in CSR form
   std::vector<std::vector<unsigned long long>> clusters{0};
 
   // Helper function to generate combinations of size r from n clusters
@@ -0,0 +1,180 @@
+#ifndef GRAPHSNAPSHOT_H_INCLUDED
+#define GRAPHSNAPSHOT_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Graph.h"
+#include "MappedFile.h"
+
+/**
+ * Graph stored in a binary snapshot file, written once by write() and
+ * mapped read-only afterwards: the adjacency is used in place, only the
+ * ground truth clusters are copied. The file holds, each part starting at a
+ * multiple of 8 bytes and in the byte order of the writing machine:
+ *
+ *   Header                 magic, version, sizes
+ *   uint64 offsets[n + 1]  CSR row starts
+ *   uint32 neighbors[m]    CSR rows
+ *   uint64 starts[c + 1]   row starts of the c truth clusters
+ *   uint32 members[s]      nodes of the truth clusters
+ *
+ * The contents are trusted beyond the sizes in the header.
+ */
+class SnapshotGraph final : public Graph {
+public:
+  static constexpr std::uint32_t VERSION = 1;
+
+  explicit SnapshotGraph(std::string filename) : path(std::move(filename)) {}
+
+  void generateGraph() override {
+    auto file = std::make_shared<const MappedFile>(path, false);
+    Header header{};
+    if (file->size() < sizeof(Header)) {
+      throw std::runtime_error("'" + path + "' is not a graph snapshot");
+    }
+    std::memcpy(&header, file->data(), sizeof(Header));
+    checkHeader(header);
+    const Layout layout(header);
+    if (file->size() != layout.total) {
+      throw std::runtime_error("graph snapshot '" + path + "' is truncated");
+    }
+
+    const char *base = file->data();
+    const auto *starts =
+        reinterpret_cast<const std::uint64_t *>(base + layout.starts);
+    const auto *members =
+        reinterpret_cast<const NodeId *>(base + layout.members);
+    clusters.assign(static_cast<size_t>(header.clusters), {});
+    for (size_t c = 0; c < clusters.size(); c++) {
+      if (starts[c] > starts[c + 1] || starts[c + 1] > header.members) {
+        throw std::runtime_error("graph snapshot '" + path + "' is corrupt");
+      }
+      clusters[c].assign(members + starts[c], members + starts[c + 1]);
+    }
+
+    adjList = CSRGraph::adopt(
+        file, reinterpret_cast<const std::uint64_t *>(base + layout.offsets),
+        reinterpret_cast<const NodeId *>(base + layout.neighbors),
+        static_cast<size_t>(header.nodes), static_cast<size_t>(header.entries));
+  }
+
+  // Stores the adjacency and ground truth of a generated graph
+  static void write(const Graph &graph, const std::string &filename) {
+    const CSRView adj = graph.getAdjList().view();
+    const auto &truth = graph.truthClusters();
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.nodes = adj.size();
+    header.entries = adj.entries();
+    header.clusters = truth.size();
+    std::vector<std::uint64_t> starts(1, 0);
+    std::vector<NodeId> members;
+    for (const auto &cluster : truth) {
+      for (const unsigned long long u : cluster) {
+        if (u >= adj.size()) {
+          throw std::out_of_range("truth cluster node out of range");
+        }
+        members.push_back(static_cast<NodeId>(u));
+      }
+      starts.push_back(members.size());
+    }
+    header.members = members.size();
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      throw std::runtime_error("cannot write '" + filename + "'");
+    }
+    out.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+    writePadded(out, adj.offsetData(),
+                (adj.size() + 1) * sizeof(std::uint64_t));
+    writePadded(out, adj.neighborData(), adj.entries() * sizeof(NodeId));
+    writePadded(out, starts.data(), starts.size() * sizeof(std::uint64_t));
+    writePadded(out, members.data(), members.size() * sizeof(NodeId));
+    if (!out.flush()) {
+      throw std::runtime_error("cannot write '" + filename + "'");
+    }
+  }
+
+  // Whether the file starts like a snapshot
+  static bool isSnapshot(const std::string &filename) {
+    char magic[sizeof(MAGIC) - 1] = {};
+    std::ifstream in(filename, std::ios::binary);
+    in.read(magic, sizeof(magic));
+    return in && std::memcmp(magic, MAGIC, sizeof(magic)) == 0;
+  }
+
+private:
+  static constexpr char MAGIC[] = "OCDGRAPH";
+  static constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+  struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint64_t nodes;
+    std::uint64_t entries;
+    std::uint64_t clusters;
+    std::uint64_t members;
+  };
+
+  // Byte positions of the parts of a file
+  struct Layout {
+    size_t offsets, neighbors, starts, members, total;
+
+    explicit Layout(const Header &header) {
+      offsets = sizeof(Header);
+      neighbors = offsets + padded((header.nodes + 1) * 8);
+      starts = neighbors + padded(header.entries * sizeof(NodeId));
+      members = starts + padded((header.clusters + 1) * 8);
+      total = members + padded(header.members * sizeof(NodeId));
+    }
+  };
+
+  std::string path;
+
+  static size_t padded(const std::uint64_t bytes) {
+    return static_cast<size_t>((bytes + 7) / 8 * 8);
+  }
+
+  static void writePadded(std::ofstream &out, const void *data,
+                          const size_t bytes) {
+    static const char zeros[8] = {};
+    out.write(static_cast<const char *>(data),
+              static_cast<std::streamsize>(bytes));
+    out.write(zeros, static_cast<std::streamsize>(padded(bytes) - bytes));
+  }
+
+  void checkHeader(const Header &header) const {
+    if (std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0) {
+      throw std::runtime_error("'" + path + "' is not a graph snapshot");
+    }
+    if (header.byteOrder != BYTE_ORDER_MARK) {
+      throw std::runtime_error("graph snapshot '" + path +
+                               "' was written with another byte order");
+    }
+    if (header.version != VERSION) {
+      throw std::runtime_error("graph snapshot '" + path + "' has version " +
+                               std::to_string(header.version) + ", expected " +
+                               std::to_string(VERSION));
+    }
+    // Sizes that cannot fit the address space would overflow the layout
+    const std::uint64_t limit = std::uint64_t{1} << 60;
+    if (header.nodes >= limit || header.entries >= limit ||
+        header.clusters >= limit || header.members >= limit) {
+      throw std::runtime_error("graph snapshot '" + path + "' is corrupt");
+    }
+  }
+};
+
+#endif // GRAPHSNAPSHOT_H_INCLUDED
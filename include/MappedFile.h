@@ -0,0 +1,88 @@
+#ifndef MAPPEDFILE_H_INCLUDED
+#define MAPPEDFILE_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define OVERCODE_HAVE_MMAP
+#endif
+
+/**
+ * Read-only view of a whole file, memory mapped where the platform allows
+ * (and read into memory elsewhere). The data starts 8-byte aligned.
+ * Mappings of the same file by several processes share the page cache.
+ */
+class MappedFile {
+public:
+  // sequential: the data will be read front to back, once
+  explicit MappedFile(const std::string &path, const bool sequential = true) {
+#ifdef OVERCODE_HAVE_MMAP
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("cannot open '" + path + "'");
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+      ::close(fd);
+      throw std::runtime_error("cannot stat '" + path + "'");
+    }
+    length = static_cast<size_t>(info.st_size);
+    if (length > 0) {
+      void *mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("cannot map '" + path + "'");
+      }
+      if (sequential) {
+        ::madvise(mapped, length, MADV_SEQUENTIAL);
+      }
+      bytes = static_cast<const char *>(mapped);
+    }
+    ::close(fd);
+#else
+    (void)sequential;
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+      throw std::runtime_error("cannot open '" + path + "'");
+    }
+    length = static_cast<size_t>(in.tellg());
+    buffer.resize((length + 7) / 8); // as aligned as a mapping
+    in.seekg(0);
+    in.read(reinterpret_cast<char *>(buffer.data()),
+            static_cast<std::streamsize>(length));
+    bytes = reinterpret_cast<const char *>(buffer.data());
+#endif
+  }
+
+  ~MappedFile() {
+#ifdef OVERCODE_HAVE_MMAP
+    if (length > 0) {
+      ::munmap(const_cast<char *>(bytes), length);
+    }
+#endif
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const char *data() const { return bytes; }
+  size_t size() const { return length; }
+
+private:
+  const char *bytes = nullptr;
+  size_t length = 0;
+#ifndef OVERCODE_HAVE_MMAP
+  std::vector<std::uint64_t> buffer;
+#endif
+};
+
+#endif // MAPPEDFILE_H_INCLUDED
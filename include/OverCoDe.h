@@ -1,19 +1,33 @@
 #ifndef OVERCODE_H_INCLUDED
 #define OVERCODE_H_INCLUDED
 
+#include "BitOps.h"
+#include "BitslicedProcess.h"
+#include "CSRGraph.h"
+#include "ClusterMembership.h"
+#include "OverCoDeOptions.h"
+#include "PushPhase.h"
 #include "RandomGenerator.h"
+#include "RunProfile.h"
+#include "RunTallies.h"
+#include "SignatureIndex.h"
+#include "SignatureMatrix.h"
+#include "StoppingRule.h"
+#include "Team.h"
+#include "ThreadPool.h"
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstddef>
-#include <ctime>
+#include <cstdint>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <thread>
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 // Define the types of tokens
@@ -50,325 +64,887 @@ public:
 };
 
 class OverCoDe {
+  // Times the phases of a run on their own (bench/bench_OVERCODE.cpp)
+  friend struct OverCoDeBenchmark;
+
 private:
-  std::vector<std::vector<unsigned long long>> G;
+  CSRView G; // Non-owning, the graph must outlive this object
   int T, k, rho, h;
   size_t ell;
   double beta, alpha;
-
-  time_t startTime{}, elapsedTime{};
-  std::vector<std::vector<int>> si;
-  std::vector<std::vector<std::vector<int>>> C;
-
-  struct vectorHash {
-    size_t operator()(const std::vector<int> &v) const {
-      size_t seed = v.size();
-      for (auto &i : v) {
-        seed ^= static_cast<size_t>(i) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-      }
-      return seed;
+  OverCoDeOptions options;
+  std::uint64_t invocations = 0; // calls of runOverCoDe, keys seeded runs
+
+  // Executes all parallel work. Given by the caller to be shared between
+  // instances, or else owned by this one.
+  std::unique_ptr<ThreadPool> ownPool;
+  ThreadPool *pool;
+
+  double elapsedSeconds = 0; // of the last runOverCoDe()
+  RunProfile runProfile;     // of the last run, if options.profile is set
+  SignatureMatrix si; // si.row(u) is the signature of node u
+  size_t runsDone = 0; // runs stored in si
+
+  // Representatives (rows of si) and the clusters they stand for: cluster c
+  // holds the nodes similar to representatives[c]
+  struct Clustering {
+    std::vector<size_t> representatives;
+    ClusterMembership memberships;
+    size_t pureSignatures = 0; // number of pure signatures among the rows
+
+    bool operator==(const Clustering &other) const {
+      return representatives == other.representatives &&
+             memberships == other.memberships;
     }
   };
+  Clustering result; // of the last runOverCoDe()
 
   // Function to randomly initialize the tokens
-  static Token randomToken() {
-    return static_cast<Token>(rng.getRandomInt(0, 1));
+  template <class Stream> static Token randomToken(Stream &stream) {
+    return static_cast<Token>(stream.next32() & 1U);
   }
 
-  // Function to execute the distributed process
-  void distributedProcess(
-      const std::vector<std::vector<unsigned long long>> &graph, size_t T_dist,
-      const int k_dist, const int rho_dist, const int h_dist,
-      const double alpha_dist,
-      std::vector<int> &receivedR,   // Reusable scratch buffer
-      std::vector<int> &receivedB,   // Reusable scratch buffer
-      std::vector<Token> &history,   // Reusable scratch buffer for X
-      std::vector<int> &runResult    // Output: Result for each node
-  ) const {
-    size_t n = graph.size();
-    size_t rounds = T_dist + 2;
-
-    // Ensure history buffer is large enough
-    if (history.size() < n * rounds) {
-      history.resize(n * rounds);
+  // Probabilities that more than half (exactly half) of ρ samples are R
+  // when each one is R with probability p
+  struct MajorityOdds {
+    double red = 0.0;
+    double tie = 0.0;
+  };
+
+  static MajorityOdds majorityOdds(const double p, const int rho_dist) {
+    MajorityOdds odds;
+    const double ratio = p / (1.0 - p);
+    double mass = 1.0; // P(j R samples), starting at j = 0
+    for (int i = 0; i < rho_dist; i++) {
+      mass *= 1.0 - p;
     }
-    // Result buffer size
-    if (runResult.size() < n) {
-      runResult.resize(n);
+    for (int j = 0; j <= rho_dist; j++) {
+      if (2 * j > rho_dist) {
+        odds.red += mass;
+      } else if (2 * j == rho_dist) {
+        odds.tie = mass;
+      }
+      mass *= ratio * (rho_dist - j) / (j + 1);
     }
+    return odds;
+  }
 
-    // Reset scratch buffers
-    std::fill(receivedR.begin(), receivedR.end(), 0);
-    std::fill(receivedB.begin(), receivedB.end(), 0);
+  // Runs per task of generateSignatures(), one word of every signature row
+  static constexpr size_t TILE_RUNS = BitslicedProcess::MAX_LANES;
+
+  // Buffers of the scalar process, shared by the members of a team
+  struct ProcessScratch {
+    std::vector<std::vector<int>> inboxes;     // R minus B received, per member
+    std::vector<int> tallyR;                   // rounds spent as R
+    std::vector<std::uint64_t> rounds[2];      // round t is in rounds[t % 2]
+    std::vector<std::uint32_t> redNeighbors;   // MajoritySampling::Counts
+    std::vector<MajorityOdds> odds;            // of a node's ρ samples
+    std::vector<std::uint32_t> oddsRed;        // redNeighbors odds are for
+    std::vector<std::vector<NodeId>> flips[2]; // flipped nodes, per member
+    TeamSum flipVolume;                        // degrees of the flipped nodes
+    TeamSum flipCount;                         // nodes flipped in a round
+    TeamSum openMembers;                       // members with open decisions
+  };
 
-    // Random Initialization: Round 0
-    for (size_t u = 0; u < n; u++) {
-      history[0 * n + u] = randomToken();
+  // Function to execute the distributed process.
+  // Only the previous and the current round are kept, as bitvectors with a
+  // set bit meaning R. The number of R rounds is tallied on the fly, since
+  // the decision only depends on that count (B rounds = T - R rounds).
+  // `run` identifies the execution to the random stream and is the column of
+  // `signatures` that receives the result. The members of
+  // `team` each handle a word-aligned share of the nodes; since the draws of
+  // a node only depend on its stream position, the result does not depend on
+  // the team size for counter-based streams. If `tallies` is set, it
+  // receives the R tally of every node in column `run`; if `counters` is
+  // set, the member adds its phase times and per-round flips to them.
+  template <class Stream>
+  void distributedProcess(
+      const CSRView &graph, size_t T_dist, const int k_dist,
+      const int rho_dist, const int h_dist, const double alpha_dist,
+      Stream &stream, const size_t run, const Team &team,
+      ProcessScratch &scratch,      // Shared by the team
+      SignatureMatrix &signatures, // Output: column `run`, one row per node
+      RunTallies *tallies = nullptr, PhaseCounters *counters = nullptr) const {
+    PhaseTimer timer(counters, options.tracer);
+    const size_t n = graph.size();
+    const size_t words = bits::wordsFor(n);
+
+    // Ensure scratch buffers are large enough
+    if (team.rank == 0) {
+      scratch.inboxes.resize(team.size);
+      for (auto &inbox : scratch.inboxes) {
+        inbox.resize(n);
+      }
+      scratch.tallyR.resize(n);
+      scratch.rounds[0].resize(words);
+      scratch.rounds[1].resize(words);
+      if (options.majoritySampling == MajoritySampling::Counts) {
+        scratch.redNeighbors.resize(n);
+        scratch.odds.resize(n);
+        scratch.oddsRed.resize(n);
+        scratch.flips[0].resize(team.size);
+        scratch.flips[1].resize(team.size);
+        scratch.flipVolume.resize(team.size);
+      }
+      scratch.flipCount.resize(team.size);
+      scratch.openMembers.resize(team.size);
+    }
+    team.sync();
+
+    const auto [firstWord, lastWord] = team.range(words);
+    const size_t first = firstWord * bits::WORD_BITS;
+    const size_t last = std::min(n, lastWord * bits::WORD_BITS);
+    std::vector<int> &inbox = scratch.inboxes[team.rank];
+    std::vector<int> &merged = scratch.inboxes[0];
+    std::vector<int> &tallyR = scratch.tallyR;
+
+    // Reset scratch buffers
+    std::fill(inbox.begin(), inbox.end(), 0);
+    std::fill(tallyR.begin() + static_cast<std::ptrdiff_t>(first),
+              tallyR.begin() + static_cast<std::ptrdiff_t>(last), 0);
+
+    // Random Initialization: Round 0, 64 nodes per draw
+    std::vector<std::uint64_t> &initial = scratch.rounds[0];
+    for (size_t w = firstWord; w < lastWord; w++) {
+      stream.position(run, StreamRound::INIT, static_cast<NodeId>(w));
+      initial[w] = stream.next64();
     }
 
     // Symmetry Breaking
-    // Step 1: Push tokens to k neighbors
-    for (size_t u = 0; u < n; u++) {
-      const auto &neighbors = graph[u];
+    // Step 1: Push tokens to k neighbors, into this member's inbox
+    for (size_t u = first; u < last; u++) {
+      const auto neighbors = graph[u];
       if (neighbors.empty())
         continue;
 
-      Token val = history[0 * n + u];
-      size_t sz = neighbors.size();
-
-      // Inline sampling
-      for (int i = 0; i < k_dist; ++i) {
-        // Optimization: Use fast RNG
-        int idx = rng.getFastRandomInt(static_cast<int>(sz) - 1);
-        unsigned long long v = neighbors[static_cast<size_t>(idx)];
-        if (val == R) {
-          ++receivedR[v];
-        } else {
-          ++receivedB[v];
+      const int val = bits::test(initial, u) ? 1 : -1;
+      stream.position(run, StreamRound::PUSH, static_cast<NodeId>(u));
+      pushTokens(neighbors, k_dist, val, options.pushSampling, inbox, stream);
+    }
+    team.sync();
+
+    // Sum the inboxes of all members into the first one
+    if (team.size > 1) {
+      for (size_t r = 1; r < team.size; r++) {
+        const std::vector<int> &shard = scratch.inboxes[r];
+        for (size_t u = first; u < last; u++) {
+          merged[u] += shard[u];
         }
       }
+      team.sync();
     }
+    timer.charge(Phase::Push);
 
     // Step 2: Sample h neighbors and check their inboxes
-    for (size_t u = 0; u < n; u++) {
-      int r_u = 0;
-      int b_u = 0;
-      const auto &neighbors = graph[u];
-
-      if (!neighbors.empty()) {
-        size_t sz = neighbors.size();
-        for (int i = 0; i < h_dist; i++) {
-          // Optimization: Use fast RNG
-          int idx = rng.getFastRandomInt(static_cast<int>(sz) - 1);
-          unsigned long long v = neighbors[static_cast<size_t>(idx)];
-          r_u += receivedR[v];
-          b_u += receivedB[v];
+    // r_u > b_u holds exactly when the summed R - B balance is positive
+    std::vector<std::uint64_t> &afterPull = scratch.rounds[1];
+    for (size_t w = firstWord; w < lastWord; w++) {
+      std::uint64_t word = 0;
+      const size_t end = std::min(n, (w + 1) * bits::WORD_BITS);
+      for (size_t u = w * bits::WORD_BITS; u < end; u++) {
+        long long balance = 0;
+        const auto neighbors = graph[u];
+        stream.position(run, StreamRound::of(1), static_cast<NodeId>(u));
+
+        if (!neighbors.empty()) {
+          const auto sz = static_cast<std::uint32_t>(neighbors.size());
+          for (int i = 0; i < h_dist; i++) {
+            balance += merged[neighbors[stream.bounded(sz)]];
+          }
         }
-      }
 
-      // Determine state based on sums
-      history[1 * n + u] =
-          ((r_u > b_u) ? R : (b_u > r_u) ? B : randomToken());
+        // Determine state based on sums
+        const Token state = (balance > 0)   ? R
+                            : (balance < 0) ? B
+                                            : randomToken(stream);
+        if (state == R) {
+          word |= std::uint64_t{1} << (u % bits::WORD_BITS);
+        }
+      }
+      afterPull[w] = word;
+    }
+    team.sync();
+    timer.charge(Phase::Pull);
+
+    StoppingRule rule(options, T_dist, alpha_dist);
+
+    // Counts mode: number of R neighbors of every node in the previous
+    // round. They are kept up to date by the nodes that flip while flips are
+    // rare, and rebuilt once they become rare again after a busy stretch.
+    // The odds of a node's samples are kept with the count they were
+    // computed for, so only nodes next to a flip recompute them.
+    const bool useCounts =
+        options.majoritySampling == MajoritySampling::Counts;
+    std::vector<std::uint32_t> &redNeighbors = scratch.redNeighbors;
+    std::vector<MajorityOdds> &nodeOdds = scratch.odds;
+    std::vector<std::uint32_t> &oddsRed = scratch.oddsRed;
+    if (useCounts) {
+      // Invalid: no count reaches the largest value
+      std::fill(oddsRed.begin() + static_cast<std::ptrdiff_t>(first),
+                oddsRed.begin() + static_cast<std::ptrdiff_t>(last),
+                ~std::uint32_t{0});
+    }
+    auto countRedNeighbors = [&](const std::vector<std::uint64_t> &state) {
+      for (size_t u = first; u < last; u++) {
+        std::uint32_t red = 0;
+        for (const NodeId v : graph[u]) {
+          red += bits::test(state, v) ? 1U : 0U;
+        }
+        redNeighbors[u] = red;
+      }
+    };
+    // Updating costs the degree of every flipped node, sampling ρ per node
+    const std::uint64_t sampleCost = n * static_cast<std::uint64_t>(rho_dist);
+    bool countsValid = useCounts;
+    if (useCounts) {
+      countRedNeighbors(afterPull);
     }
 
     // ρ-Majority process
     for (size_t t = 2; t <= T_dist + 1; t++) {
-      size_t prev_round_offset = (t - 1) * n;
-      size_t curr_round_offset = t * n;
+      const std::vector<std::uint64_t> &previous = scratch.rounds[(t - 1) % 2];
+      std::vector<std::uint64_t> &current = scratch.rounds[t % 2];
+
+      for (size_t w = firstWord; w < lastWord; w++) {
+        std::uint64_t word = 0;
+        const size_t end = std::min(n, (w + 1) * bits::WORD_BITS);
+        for (size_t u = w * bits::WORD_BITS; u < end; u++) {
+          const auto neighbors = graph[u];
+          int countB = 0;
+          int countR = 0;
+          stream.position(run, StreamRound::of(t), static_cast<NodeId>(u));
+
+          if (!neighbors.empty() && countsValid) {
+            // Only the outcome of the ρ samples matters: a single draw
+            // against its probabilities (countR = countB means a tie)
+            const auto sz = static_cast<std::uint32_t>(neighbors.size());
+            const std::uint32_t red = redNeighbors[u];
+            if (red == 0 || red == sz) {
+              (red == 0 ? countB : countR) = rho_dist;
+            } else {
+              if (oddsRed[u] != red) {
+                nodeOdds[u] =
+                    majorityOdds(static_cast<double>(red) / sz, rho_dist);
+                oddsRed[u] = red;
+              }
+              const MajorityOdds &odds = nodeOdds[u];
+              const double x = uniformUnit(stream);
+              if (x < odds.red) {
+                countR = 1;
+              } else if (x >= odds.red + odds.tie) {
+                countB = 1;
+              }
+            }
+          } else if (!neighbors.empty()) {
+            const auto sz = static_cast<std::uint32_t>(neighbors.size());
+            for (int i = 0; i < rho_dist; i++) {
+              bits::test(previous, neighbors[stream.bounded(sz)]) ? countR++
+                                                                  : countB++;
+            }
+          }
 
-      for (size_t u = 0; u < n; u++) {
-        const auto &neighbors = graph[u];
-        int countB = 0;
-        int countR = 0;
+          const Token state = (countR > countB)   ? R
+                              : (countR < countB) ? B
+                                                  : randomToken(stream);
+          if (state == R) {
+            word |= std::uint64_t{1} << (u % bits::WORD_BITS);
+            tallyR[u]++;
+          }
+        }
+        current[w] = word;
+      }
 
-        if (!neighbors.empty()) {
-          size_t sz = neighbors.size();
-          for (int i = 0; i < rho_dist; i++) {
-            // Optimization: Use fast RNG
-            int idx = rng.getFastRandomInt(static_cast<int>(sz) - 1);
-            unsigned long long v = neighbors[static_cast<size_t>(idx)];
-            Token prev = history[prev_round_offset + v];
-            (prev == R) ? countR++ : countB++;
+      // Statistics of this round, summed over the team after the sync
+      const size_t elapsed = t - 1;
+      std::uint64_t flips = 0;
+      if (useCounts) {
+        // Only the nodes that flipped update the counts of their neighbors.
+        // The flip lists alternate between rounds, so a member may refill
+        // its list while the others still read the one of the previous
+        // round.
+        std::vector<NodeId> &flipped = scratch.flips[t % 2][team.rank];
+        std::uint64_t volume = 0;
+        flipped.clear();
+        for (size_t w = firstWord; w < lastWord; w++) {
+          std::uint64_t changed = previous[w] ^ current[w];
+          while (changed != 0) {
+            const auto v = static_cast<NodeId>(
+                w * bits::WORD_BITS + bits::countTrailingZeros(changed));
+            flipped.push_back(v);
+            volume += graph.degree(v);
+            changed &= changed - 1;
           }
         }
+        flips = flipped.size();
+        scratch.flipVolume.part(t, team.rank) = volume;
+      } else if (rule.countsFlips() || counters != nullptr) {
+        for (size_t w = firstWord; w < lastWord; w++) {
+          flips += bits::popcount(previous[w] ^ current[w]);
+        }
+      }
+      scratch.flipCount.part(t, team.rank) = flips;
+      if (counters != nullptr) {
+        counters->addRound(elapsed, team.rank == 0 ? 1 : 0, flips);
+      }
 
-        history[curr_round_offset + u] =
-            ((countR > countB) ? R : (countR < countB) ? B : randomToken());
+      bool fixed = rule.checksDecisions();
+      for (size_t u = first; fixed && u < last; u++) {
+        fixed = rule.isFixed(static_cast<std::uint64_t>(tallyR[u]), elapsed);
+      }
+      scratch.openMembers.part(t, team.rank) = fixed ? 0 : 1;
+      team.sync();
+
+      // Every member takes the same decisions from the totals
+      if (rule.stop(elapsed, scratch.openMembers.total(t) == 0,
+                    scratch.flipCount.total(t), n)) {
+        const auto remaining = static_cast<int>(T_dist - elapsed);
+        for (size_t u = first; u < last; u++) {
+          tallyR[u] += bits::test(current, u) ? remaining : 0;
+        }
+        break;
+      }
+      if (!useCounts) {
+        continue;
       }
-    }
 
-    // Calculate the result for this run immediately to save memory
-    // Reuse receivedR/receivedB as counters to avoid allocation
-    std::fill(receivedR.begin(), receivedR.end(), 0);
-    std::fill(receivedB.begin(), receivedB.end(), 0);
+      const std::uint64_t totalVolume = scratch.flipVolume.total(t);
+      if (!countsValid) {
+        if (totalVolume <= sampleCost / 2) {
+          countRedNeighbors(current);
+          countsValid = true;
+        }
+        continue;
+      }
+      if (totalVolume > sampleCost * 2) {
+        countsValid = false; // sampling neighbors is cheaper for now
+        continue;
+      }
 
-    for (size_t hist_idx = 2; hist_idx <= T_dist + 1; hist_idx++) {
-      size_t round_offset = hist_idx * n;
-      for (size_t u = 0; u < n; ++u) {
-        Token t = history[round_offset + u];
-        (t == R) ? receivedR[u]++ : receivedB[u]++;
+      // Every member applies all flips to the nodes it owns
+      for (const std::vector<NodeId> &memberFlips : scratch.flips[t % 2]) {
+        for (const NodeId v : memberFlips) {
+          const bool nowRed = bits::test(current, v);
+          for (const NodeId w : graph[v]) {
+            if (w >= first && w < last) {
+              nowRed ? redNeighbors[w]++ : redNeighbors[w]--;
+            }
+          }
+        }
       }
     }
+    timer.charge(Phase::Majority);
 
+    // Calculate the result for this run
+    const int rounds = static_cast<int>(T_dist);
     double threshold = alpha_dist * static_cast<double>(T_dist);
-    for (size_t u = 0; u < n; ++u) {
-      if (receivedR[u] >= threshold) {
-        runResult[u] = R;
-      } else if (receivedB[u] >= threshold) {
-        runResult[u] = B;
+    for (size_t u = first; u < last; ++u) {
+      if (tallyR[u] >= threshold) {
+        signatures.setShared(u, run, R);
+      } else if (rounds - tallyR[u] >= threshold) {
+        signatures.setShared(u, run, B);
       } else {
-        runResult[u] = -1; // Assume -1 indicates uncertainty
+        signatures.setShared(u, run, -1); // Assume -1 indicates uncertainty
+      }
+      if (tallies != nullptr) {
+        tallies->set(u, run, static_cast<std::uint64_t>(tallyR[u]));
       }
     }
+    timer.charge(Phase::Tally);
   }
 
-  /**
-   * goal: if we have
-   * vec1: R B B U R U B
-   * vec2: B B R U R B B
-   * valid:0 1 0 0 1 0 1
-   * we would get (3 / 7)
-   * @return Similarity between signatures
-   */
-  static double similarity(const std::vector<int> &a,
-                           const std::vector<int> &b) {
-    int common = 0, validIndices = 0;
-
-    for (size_t i = 0; i < std::min(a.size(), b.size()); i++) {
-      if (a[i] != -1 && b[i] != -1) { // Ensure both indices are valid
-        validIndices++;
-        if (a[i] == b[i]) {
-          common++;
+  // Number of worker threads to use
+  size_t workerThreads() const { return pool->size(); }
+
+  // Splits the worker threads into teams, see planTeams()
+  TeamPlan planParallelism(const size_t taskCount) const {
+    const size_t threads = workerThreads();
+    if (options.parallelism == Parallelism::Nodes) {
+      return {1, threads};
+    }
+    return planTeams(G.size(), taskCount, threads,
+                     options.parallelism == Parallelism::Auto);
+  }
+
+  // Executes runs firstRun .. firstRun + runCount - 1 on worker threads and
+  // stores the result of run r in column r of `signatures`. firstRun must be
+  // a multiple of 64. Each worker gets its random stream from makeStream().
+  // If `tallies` is set, it receives the R tallies of the runs as well, and
+  // if `profile` is set, every worker counts into its slot of it.
+  // A bitsliced task is a tile of up to 64 runs, i.e. one word of every row,
+  // so its tasks never write to the same word. A scalar task is a single run
+  // that sets its column with atomic bit updates. Workers are grouped into
+  // teams; the members of a team execute the same task, each on its share of
+  // the nodes (rows).
+  template <class MakeStream>
+  void generateSignatures(const size_t firstRun, const size_t runCount,
+                          SignatureMatrix &signatures, MakeStream makeStream,
+                          RunTallies *tallies = nullptr,
+                          RunProfile *profile = nullptr) const {
+    // Atomic counter for distributing work
+    std::atomic<size_t> nextTaskIndex{0};
+
+    // The bitsliced engine executes the runs of a tile at once, the scalar
+    // one run per task
+    const bool bitsliced = options.engine == SignatureEngine::Bitsliced;
+    const size_t taskRuns = bitsliced ? TILE_RUNS : 1;
+    const size_t taskCount = (runCount + taskRuns - 1) / taskRuns;
+    const TeamPlan plan = planParallelism(taskCount);
+
+    // State shared by the members of a team. It lives in the pool's arena of
+    // the team, so its buffers are reused by later calls.
+    struct TeamState {
+      std::unique_ptr<Barrier> barrier;
+      size_t task = 0; // published by the leader
+      ProcessScratch scratch;
+      BitslicedProcess process;
+      std::vector<std::uint64_t> red;
+      std::vector<std::uint64_t> blue;
+    };
+
+    auto member = [this, &signatures, tallies, &nextTaskIndex, &makeStream,
+                   taskCount, taskRuns, bitsliced, &plan, firstRun,
+                   runCount](TeamState &state, const size_t rank,
+                             PhaseCounters *counters) {
+      const Team team{rank, plan.teamSize,
+                      plan.teamSize > 1 ? state.barrier.get() : nullptr};
+      auto stream = makeStream();
+
+      while (true) {
+        if (team.rank == 0) {
+          state.task = nextTaskIndex.fetch_add(1);
+        }
+        team.sync();
+        const size_t task = state.task;
+        if (task >= taskCount) {
+          return;
+        }
+        const size_t offset = task * taskRuns;
+        TraceScope scope(options.tracer, "task", "first_run",
+                         firstRun + offset);
+
+        if (!bitsliced) {
+          distributedProcess(this->G, static_cast<size_t>(this->T), this->k,
+                             this->rho, this->h, this->alpha, stream,
+                             firstRun + offset, team, state.scratch,
+                             signatures, tallies, counters);
+          team.sync();
+          continue;
+        }
+
+        const size_t lanes = std::min(TILE_RUNS, runCount - offset);
+
+        state.process.run(this->G, static_cast<size_t>(this->T), this->k,
+                          this->rho, this->h, this->alpha, stream,
+                          firstRun + offset, lanes, team, state.red,
+                          state.blue, counters);
+
+        // Lane i of a node's words is run firstRun + offset + i, so the
+        // words go straight into this member's rows
+        PhaseTimer timer(counters, options.tracer);
+        const size_t word = (firstRun + offset) / TILE_RUNS;
+        const auto [first, last] = team.range(this->G.size());
+        for (size_t u = first; u < last; u++) {
+          signatures.setWord(u, word, state.red[u] | state.blue[u],
+                             state.blue[u]);
+          for (size_t lane = 0; tallies != nullptr && lane < lanes; lane++) {
+            tallies->set(u, firstRun + offset + lane,
+                         state.process.tallyR(u, lane));
+          }
         }
+        team.sync();
+        timer.charge(Phase::Tally);
       }
+    };
+
+    std::vector<TeamState *> teams;
+    for (size_t t = 0; t < plan.teams; ++t) {
+      TeamState &state = pool->arena(t).get<TeamState>();
+      state.barrier = std::make_unique<Barrier>(plan.teamSize);
+      state.process.setOptions(options);
+      teams.push_back(&state);
     }
 
-    if (validIndices == 0) {
-      return 0.0; // Avoid division by zero if there are no valid indices
+    const size_t members = plan.teams * plan.teamSize;
+    if (profile != nullptr && profile->workers.size() < members) {
+      profile->workers.resize(members);
     }
 
-    return static_cast<double>(common) /
-           validIndices; // Ratio of matching valid states
+    // One pool thread per member, team by team
+    pool->concurrently(members, [&](const size_t slot) {
+      member(*teams[slot / plan.teamSize], slot % plan.teamSize,
+             profile != nullptr ? &profile->workers[slot] : nullptr);
+    });
   }
 
-  static std::vector<std::vector<int>>
-  clustersIDs(const std::vector<std::vector<int>> &S,
-              const double similarity_threshold) {
-    std::vector<std::vector<int>> signatures;
-    for (const auto &signatureV : S) {
-      bool isUnique = true;
-      for (const auto &signatureU : signatures) {
-        if (similarity(signatureU, signatureV) >= similarity_threshold) {
-          isUnique = false;
-          break;
+  // Greedily picks representatives among the pure signatures (rows of si):
+  // a signature becomes a new representative unless it is similar to one
+  // picked before. Returns the rows of the representatives.
+  // The signatures are taken in blocks: each is first compared, in parallel,
+  // with the representatives picked before its block, and the few left are
+  // then compared in order with the ones picked within the block. With
+  // lshRecall < 1 the first comparison only covers the candidates of a
+  // SignatureIndex, which may let a signature through that an earlier
+  // representative would have covered.
+  // decided[u] is the decided count of row u, `runs` the number of filled
+  // columns.
+  std::vector<size_t>
+  clustersIDs(const SignatureMatrix &sigs, const size_t runs,
+              const std::vector<size_t> &S, const double similarity_threshold,
+              const std::vector<std::uint64_t> &decided) const {
+    constexpr size_t BLOCK = 1024;
+    const bool useIndex = options.lshRecall < 1.0 && runs > 0;
+
+    std::vector<size_t> signatures;
+    SignatureIndex index(runs, similarity_threshold, options.lshRecall);
+    const size_t tables = index.tables();
+    std::vector<std::uint32_t> keys;
+    if (useIndex) {
+      keys.resize(S.size() * tables);
+      pool->parallelFor(S.size(), [&](const size_t i) {
+        index.keys(sigs.row(S[i]), &keys[i * tables]);
+      });
+    }
+
+    auto similar = [&](const size_t signatureU, const size_t signatureV) {
+      return isSimilar(sigs.row(signatureU), sigs.row(signatureV),
+                       similarity_threshold,
+                       std::min(decided[signatureU], decided[signatureV]));
+    };
+
+    std::vector<char> covered;
+    for (size_t start = 0; start < S.size(); start += BLOCK) {
+      const size_t end = std::min(S.size(), start + BLOCK);
+      const size_t known = signatures.size();
+
+      // Compare with the representatives picked before this block
+      covered.assign(end - start, 0);
+      pool->parallelFor(end - start, [&](const size_t i) {
+        const size_t signatureV = S[start + i];
+        if (!useIndex) {
+          for (size_t c = 0; c < known && !covered[i]; c++) {
+            covered[i] = similar(signatures[c], signatureV);
+          }
+          return;
+        }
+        thread_local std::vector<std::uint32_t> candidates;
+        index.candidates(&keys[(start + i) * tables], candidates);
+        for (size_t c = 0; c < candidates.size() && !covered[i]; c++) {
+          covered[i] = similar(signatures[candidates[c]], signatureV);
+        }
+      });
+
+      // Then with the ones picked within it, in order
+      for (size_t i = start; i < end; i++) {
+        if (covered[i - start]) {
+          continue;
+        }
+        bool isUnique = true;
+        for (size_t c = known; c < signatures.size() && isUnique; c++) {
+          isUnique = !similar(signatures[c], S[i]);
+        }
+        if (isUnique) {
+          if (useIndex) {
+            index.insert(static_cast<std::uint32_t>(signatures.size()),
+                         &keys[i * tables]);
+          }
+          signatures.push_back(S[i]);
         }
-      }
-      if (isUnique) {
-        signatures.push_back(signatureV);
       }
     }
     return signatures;
   }
 
-public:
-  OverCoDe(const std::vector<std::vector<unsigned long long>> &adjList,
-           const int rounds, const int pushes, const int majoritySamples,
-           const int sampleSize, size_t L, const double p_beta,
-           const double p_alpha)
-      : G(adjList), T(rounds), k(pushes), rho(majoritySamples), h(sampleSize),
-        ell(L), beta(p_beta), alpha(p_alpha) {
-    si.resize(G.size());
-    C.resize(G.size());
+  // Clusters the signatures of the first runsDone runs
+  Clustering clusterSignatures(PhaseCounters *counters = nullptr) const {
+    return clusterSignatures(si, runsDone, beta, counters);
   }
 
-  void runOverCoDe() {
-    startTime = time(nullptr);
+  // Clusters the first `runs` columns of sigs with similarity threshold
+  // beta_dist. If `counters` is set, the phase times are added to them.
+  Clustering clusterSignatures(const SignatureMatrix &sigs, const size_t runs,
+                               const double beta_dist,
+                               PhaseCounters *counters = nullptr) const {
+    PhaseTimer timer(counters, options.tracer);
+    std::vector<std::uint64_t> decided(G.size());
+    pool->parallelFor(G.size(), [&](const size_t u) {
+      decided[u] = sigs.decidedCount(u);
+    });
 
-    // Generate Signatures
-    // this provides a vector which has the most common result for every node in
-    // each iteration
-    si.resize(G.size());
-    // Clear previous results if any
-    for (auto &s : si)
-      s.clear();
-    // Pre-allocate si for performance (we know we will add 'ell' elements)
-    for (auto &s : si)
-      s.reserve(ell);
+    // Identify Clusters
+    std::vector<size_t> pureSignatures;
+    for (size_t u = 0; u < G.size(); ++u) {
+      if (static_cast<double>(decided[u]) >=
+          beta_dist * static_cast<double>(runs)) {
+        pureSignatures.push_back(u);
+      }
+    }
+    timer.charge(Phase::Purity);
+
+    Clustering clustering;
+    clustering.pureSignatures = pureSignatures.size();
+    clustering.representatives =
+        clustersIDs(sigs, runs, pureSignatures, beta_dist, decided);
+    timer.charge(Phase::Representatives);
+
+    // Every node's clusters are filled by the thread that takes the node
+    const std::vector<size_t> &reps = clustering.representatives;
+    std::vector<std::vector<ClusterId>> clustersOfNode(G.size());
+    pool->parallelFor(G.size(), [&](const size_t u) {
+      for (size_t c = 0; c < reps.size(); c++) {
+        if (isSimilar(sigs.row(u), sigs.row(reps[c]), beta_dist,
+                      std::min(decided[u], decided[reps[c]]))) {
+          clustersOfNode[u].push_back(static_cast<ClusterId>(c));
+        }
+      }
+    });
+    clustering.memberships = ClusterMembership(clustersOfNode, reps.size());
+    timer.charge(Phase::Assignment);
+    return clustering;
+  }
 
-    // Stores results from threads: [run_index][node_index]
-    std::vector<std::vector<int>> runResults(ell);
+  // Every call of runOverCoDe or sweep gets its own key, derived from the
+  // seed
+  std::uint64_t nextKey() {
+    std::uint64_t state =
+        options.seed ? *options.seed ^ (invocations * 0xd1b54a32d192ed03ULL)
+                     : 0;
+    invocations++;
+    return splitMix64(state);
+  }
 
-    // Atomic counter for distributing work
-    std::atomic<size_t> nextTaskIndex{0};
+  // generateSignatures() with counter-based streams of the given key if
+  // seeded, randomly seeded ones otherwise
+  void generateRuns(const size_t firstRun, const size_t runCount,
+                    SignatureMatrix &signatures, const std::uint64_t key,
+                    RunTallies *tallies = nullptr,
+                    RunProfile *profile = nullptr) const {
+    if (options.seed) {
+      generateSignatures(
+          firstRun, runCount, signatures,
+          [key]() { return CounterStream(key); }, tallies, profile);
+    } else {
+      generateSignatures(
+          firstRun, runCount, signatures,
+          []() { return SequentialStream(rng.getRandomUll(0, ~0ULL)); },
+          tallies, profile);
+    }
+  }
 
-    // Determine number of worker threads
-    size_t hw = std::thread::hardware_concurrency();
-    size_t maxThreads = (hw > 0) ? hw : 4;
-    size_t numThreads = std::min(maxThreads, ell);
-    std::vector<std::thread> workers;
-
-    // Worker lambda
-    auto worker = [this, &runResults, &nextTaskIndex]() {
-      // Thread-local scratch buffers to avoid reallocation
-      std::vector<int> localRecR(this->G.size(), 0);
-      std::vector<int> localRecB(this->G.size(), 0);
-      size_t rounds = static_cast<size_t>(this->T + 2);
-      std::vector<Token> localHistory(this->G.size() * rounds);
-      std::vector<int> localResult(this->G.size());
+  // Starts the profile of a run, if profiling is enabled
+  RunProfile *startProfile() {
+    runProfile = RunProfile();
+    if (!options.profile) {
+      return nullptr;
+    }
+    runProfile.workers.resize(workerThreads());
+    runProfile.nodes = G.size();
+    return &runProfile;
+  }
 
-      while (true) {
-        size_t i = nextTaskIndex.fetch_add(1);
-        if (i >= this->ell) {
-          return;
-        }
+  // Number of undecided entries in the first `runs` columns of sigs
+  std::uint64_t undecidedEntries(const SignatureMatrix &sigs,
+                                 const size_t runs) const {
+    std::uint64_t undecided = 0;
+    for (size_t u = 0; u < sigs.rows(); u++) {
+      undecided += runs - sigs.decidedCount(u);
+    }
+    return undecided;
+  }
 
-        distributedProcess(this->G, static_cast<size_t>(this->T), this->k,
-                           this->rho, this->h, this->alpha, localRecR,
-                           localRecB, localHistory, localResult);
+public:
+  OverCoDe(const CSRView graph, const int rounds, const int pushes,
+           const int majoritySamples, const int sampleSize, size_t L,
+           const double p_beta, const double p_alpha,
+           const OverCoDeOptions &opts = OverCoDeOptions(),
+           ThreadPool *sharedPool = nullptr)
+      : G(graph), T(rounds), k(pushes), rho(majoritySamples), h(sampleSize),
+        ell(L), beta(p_beta), alpha(p_alpha), options(opts),
+        ownPool(sharedPool ? nullptr
+                           : std::make_unique<ThreadPool>(options.threads)),
+        pool(sharedPool ? sharedPool : ownPool.get()) {}
 
-        // Store compacted result
-        runResults[i] = localResult;
+  void runOverCoDe() {
+    TraceScope scope(options.tracer, "runOverCoDe");
+    const auto start = std::chrono::steady_clock::now();
+    RunProfile *profile = startProfile();
+    PhaseCounters *caller = profile ? &profile->caller : nullptr;
+
+    // Generate Signatures
+    // this provides a vector which has the most common result for every node in
+    // each iteration
+    // Clear previous results if any
+    si.reset(G.size(), ell);
+    runsDone = 0;
+    result = Clustering();
+
+    const std::uint64_t key = nextKey();
+
+    // Anytime mode: batches of runs, until the clustering stops changing
+    const bool anytime = options.batchRuns > 0;
+    const size_t batch =
+        anytime ? (options.batchRuns + BitslicedProcess::MAX_LANES - 1) /
+                      BitslicedProcess::MAX_LANES * BitslicedProcess::MAX_LANES
+                : ell;
+    Clustering clustering;
+    size_t stableBatches = 0;
+
+    while (runsDone < ell) {
+      // Workers write their runs straight into si
+      const size_t runCount = std::min(batch, ell - runsDone);
+      const auto generating = std::chrono::steady_clock::now();
+      {
+        TraceScope batchScope(options.tracer, "signatures", "runs", runCount);
+        generateRuns(runsDone, runCount, si, key, nullptr, profile);
+      }
+      runsDone += runCount;
+      if (profile != nullptr) {
+        profile->signatureSeconds += secondsSince(generating);
+      }
+      if (!anytime) {
+        break;
       }
-    };
 
-    // Spawn workers
-    for (size_t i = 0; i < numThreads; ++i) {
-      workers.emplace_back(worker);
+      Clustering next = clusterSignatures(caller);
+      stableBatches = next == clustering ? stableBatches + 1 : 0;
+      clustering = std::move(next);
+      if (stableBatches >= options.stableBatches ||
+          (options.timeBudget > 0 &&
+           secondsSince(start) >= options.timeBudget)) {
+        break;
+      }
     }
 
-    // Join workers
-    for (auto &t : workers) {
-      t.join();
+    std::cout << "Done generating signatures" << std::endl;
+
+    result = anytime ? std::move(clustering) : clusterSignatures(caller);
+
+    elapsedSeconds = secondsSince(start); // used in printClustersToFile
+    if (profile != nullptr) {
+      profile->totalSeconds = elapsedSeconds;
+      profile->runs = runsDone;
+      profile->undecided = undecidedEntries(si, runsDone);
+      profile->pureNodes = result.pureSignatures;
+      profile->clusters = result.memberships.clusters();
     }
+  }
 
-    // Transpose results: runResults[run][node] -> si[node][run]
-    for (size_t u = 0; u < G.size(); ++u) {
-      for (size_t i = 0; i < ell; i++) {
-        si[u].push_back(runResults[i][u]);
+  // Clustering of one point of a sweep()
+  struct SweepResult {
+    double alpha = 0;
+    double beta = 0;
+    ClusterMembership clusters;
+    // Signature of the representative of every cluster
+    std::vector<std::vector<int>> representatives;
+  };
+
+  /**
+   * Clusters the same ell runs for every combination of the given alphas
+   * and betas, alpha-major. The runs are generated once, keeping the R
+   * tally of every node in every run; the signatures at each alpha are
+   * thresholded from the tallies, and the grid points are clustered in
+   * parallel. Gives the results runOverCoDe would give for each point with
+   * the same runs. The anytime mode does not apply, and the current result
+   * and signatures are left alone. The profile counts the signatures at the
+   * own alpha, and pure nodes, clusters and clustering times summed over
+   * the grid points.
+   */
+  std::vector<SweepResult> sweep(const std::vector<double> &alphas,
+                                 const std::vector<double> &betas) {
+    TraceScope scope(options.tracer, "sweep");
+    const auto start = std::chrono::steady_clock::now();
+    RunProfile *profile = startProfile();
+    const std::uint64_t key = nextKey();
+    const size_t n = G.size();
+
+    // An early stop has to keep the decisions of every alpha exact
+    RunTallies tallies;
+    tallies.reset(n, ell, static_cast<size_t>(T));
+    {
+      TraceScope generating(options.tracer, "signatures", "runs", ell);
+      SignatureMatrix atAlpha(n, ell);
+      // The grid's alphas are appended for this call only, and removed
+      // again also if generating throws
+      struct RestoreAlphas {
+        std::vector<double> &alphas;
+        const size_t count;
+        ~RestoreAlphas() { alphas.resize(count); }
+      } restore{options.sweepAlphas, options.sweepAlphas.size()};
+      options.sweepAlphas.insert(options.sweepAlphas.end(), alphas.begin(),
+                                 alphas.end());
+      generateRuns(0, ell, atAlpha, key, &tallies, profile);
+      if (profile != nullptr) {
+        profile->signatureSeconds = secondsSince(start);
+        profile->runs = ell;
+        profile->undecided = undecidedEntries(atAlpha, ell);
       }
     }
-
     std::cout << "Done generating signatures" << std::endl;
 
-    std::vector<std::vector<int>> pureSignatures;
+    std::vector<SignatureMatrix> signaturesAt(alphas.size());
+    for (size_t a = 0; a < alphas.size(); a++) {
+      TraceScope deciding(options.tracer, "decide", "alpha_index", a);
+      tallies.decide(alphas[a], signaturesAt[a], *pool);
+    }
 
-    // Identify Clusters
-    for (size_t u = 0; u < G.size(); ++u) {
-      // if (bernoulli(log((double)G.size()) / (double)G.size())) {
-      if (static_cast<double>(count_if(si[u].begin(), si[u].end(),
-                                       [](const int x) { return x != -1; })) >=
-          beta * static_cast<double>(ell)) {
-        pureSignatures.push_back(si[u]);
+    std::vector<SweepResult> results(alphas.size() * betas.size());
+    std::vector<PhaseCounters> pointCounters(results.size());
+    std::vector<size_t> pointPure(results.size());
+    pool->parallelFor(results.size(), [&](const size_t point) {
+      const size_t a = point / betas.size();
+      SweepResult &out = results[point];
+      out.alpha = alphas[a];
+      out.beta = betas[point % betas.size()];
+      Clustering clustering =
+          clusterSignatures(signaturesAt[a], ell, out.beta,
+                            profile ? &pointCounters[point] : nullptr);
+      pointPure[point] = clustering.pureSignatures;
+      out.clusters = std::move(clustering.memberships);
+      for (const size_t rep : clustering.representatives) {
+        out.representatives.push_back(signaturesAt[a].unpack(rep, ell));
       }
-      //}
+    });
+
+    if (profile != nullptr) {
+      // The grid points were clustered on the workers at once, so their
+      // phases count as thread-seconds
+      PhaseCounters grid;
+      for (size_t point = 0; point < results.size(); point++) {
+        grid.merge(pointCounters[point]);
+        profile->pureNodes += pointPure[point];
+        profile->clusters += results[point].clusters.clusters();
+      }
+      profile->workers.push_back(std::move(grid));
+      profile->totalSeconds = secondsSince(start);
     }
+    return results;
+  }
 
-    std::vector<std::vector<int>> signatures =
-        clustersIDs(pureSignatures, beta);
+  // Measurements of the last runOverCoDe() or sweep(); empty unless
+  // options.profile is set
+  const RunProfile &profile() const { return runProfile; }
 
-    std::cout << "Got Pure Signatures" << std::endl;
-    // #pragma omp parallel for
-    for (size_t u = 0; u < G.size(); ++u) {
-      for (const std::vector<int> &signature : signatures) {
-        if (similarity(si[u], signature) >= beta) {
-          // #pragma omp critical
-          C[u].push_back(signature);
-        }
-      }
-    }
+  // Number of runs behind the current signatures, ell unless the anytime
+  // mode stopped early
+  size_t signatureRuns() const { return runsDone; }
 
-    elapsedTime = time(nullptr) - startTime; // used in printClustersToFile
-  }
+  // Signature of every node, one row per node and one column per run; only
+  // the first signatureRuns() columns are filled
+  const SignatureMatrix &signatures() const { return si; }
 
-  const std::vector<std::vector<std::vector<int>>> &getResults() const {
-    return C;
+  // Clusters found by the last runOverCoDe(); cluster c is identified by
+  // the signature representative(c)
+  const ClusterMembership &getClusters() const { return result.memberships; }
+
+  // Signature of the representative of cluster c
+  std::vector<int> representative(const size_t c) const {
+    return si.unpack(result.representatives[c], runsDone);
   }
 
   void printResults() const {
-    for (size_t i = 0; i < C.size(); i++) {
+    for (size_t i = 0; i < G.size(); i++) {
       std::cout << "Clusters node " << i << " is in: " << std::endl;
-      for (const auto &j : C[i]) {
-        for (const int x : j) {
+      for (const ClusterId c : getClusters().clustersOf(i)) {
+        for (const int x : representative(c)) {
           std::cout << x << " ";
         }
         std::cout << " / ";
@@ -377,16 +953,14 @@ public:
     }
   }
 
-  void printHistoryToFile(const std::string &filename) {
+  void printHistoryToFile(const std::string &filename) const {
     std::ofstream c;
     c.open(filename);
-    int i = 0;
-
-    for (std::vector<int> &vec : si) {
-      c << i << std::endl;
-      i++;
-      for (int &node : vec) {
-        c << node << " ";
+    const SignatureMatrix &history = signatures();
+    for (size_t u = 0; u < history.rows(); u++) {
+      c << u << std::endl;
+      for (size_t i = 0; i < signatureRuns(); i++) {
+        c << history.value(u, i) << " ";
       }
       c << std::endl << std::endl;
     }
@@ -395,28 +969,15 @@ public:
     std::cout << "history written" << std::endl;
   }
 
-  std::unordered_map<std::vector<int>, std::unordered_set<int>, vectorHash>
-  getClusters() const {
-    std::unordered_map<std::vector<int>, std::unordered_set<int>, vectorHash>
-        clusters;
-    for (size_t i = 0; i < C.size(); i++) {
-      for (size_t j = 0; j < C[i].size(); j++) {
-        clusters[C[i][j]].insert(static_cast<int>(i));
-      }
-    }
-    return clusters;
-  }
-
   void printClusters() const {
-    const auto clusters = getClusters();
-    int i = 0;
-    for (const auto &pair : clusters) {
-      std::cout << "Cluster " << ++i << ": ";
-      for (int num : pair.first) {
+    const ClusterMembership &clusters = getClusters();
+    for (size_t c = 0; c < clusters.clusters(); c++) {
+      std::cout << "Cluster " << c + 1 << ": ";
+      for (const int num : representative(c)) {
         std::cout << num << " ";
       }
       std::cout << std::endl << "Nodes: ";
-      for (int num : pair.second) {
+      for (const NodeId num : clusters.nodesOf(c)) {
         std::cout << num << " ";
       }
       std::cout << std::endl;
@@ -426,22 +987,19 @@ public:
   void printClustersToFile(const std::string &name) const {
     std::ofstream f;
     f.open(name);
-    int i = 0;
-    const auto clusters = getClusters();
-    // Cannot use structured bindings here with c++11
-    // ReSharper disable once CppUseStructuredBinding
-    for (const auto &cluster : clusters) {
-      f << "Cluster " << ++i << ": ";
-      for (const int num : cluster.first) {
+    const ClusterMembership &clusters = getClusters();
+    for (size_t c = 0; c < clusters.clusters(); c++) {
+      f << "Cluster " << c + 1 << ": ";
+      for (const int num : representative(c)) {
         f << num << " ";
       }
       f << std::endl << "Nodes: ";
-      for (const int num : cluster.second) {
+      for (const NodeId num : clusters.nodesOf(c)) {
         f << num << " ";
       }
       f << std::endl;
     }
-    f << "Time taken: ~" << elapsedTime << "s" << std::endl;
+    f << "Time taken: ~" << elapsedSeconds << "s" << std::endl;
     f.close();
   }
 };
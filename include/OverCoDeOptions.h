@@ -0,0 +1,90 @@
+#ifndef OVERCODEOPTIONS_H_INCLUDED
+#define OVERCODEOPTIONS_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+class Tracer;
+
+// Implementation used to generate the signatures
+enum class SignatureEngine {
+  Scalar,   // one run per task, one bit per node
+  Bitsliced // 64 runs per task, one 64-bit word per node (BitslicedProcess)
+};
+
+// How the k pushes of a node are spread over its neighbors
+enum class PushSampling {
+  Auto,       // Multinomial when k is large compared to the degree
+  Exact,      // k uniform neighbor draws, O(k)
+  Multinomial // per-neighbor counts from conditional binomials, O(degree)
+};
+
+// How a node draws its ρ samples in the scalar engine
+enum class MajoritySampling {
+  Neighbors, // ρ random neighbors, looking up their tokens
+  Counts     // from its number of R neighbors, updated by the nodes that flip
+};
+
+// When a run ends its ρ-majority rounds (see StoppingRule.h)
+enum class Termination {
+  Full,    // always after T rounds
+  Decided, // once no remaining round can change a node's decision
+  Stable   // also once few nodes flipped for `patience` rounds in a row
+};
+
+// How the worker threads share the runs
+enum class Parallelism {
+  Auto,  // one thread per task, spare threads split the nodes of large graphs
+  Runs,  // one thread per task
+  Nodes  // all threads on one task at a time, each on a share of the nodes
+};
+
+// Tuning knobs of OverCoDe. Apart from Termination::Stable and lshRecall < 1
+// they do not change what the algorithm computes.
+struct OverCoDeOptions {
+  SignatureEngine engine = SignatureEngine::Bitsliced;
+
+  // Unset: every worker draws from its own randomly seeded xoshiro256++.
+  // Set: counter-based Philox streams keyed by (seed, run, round, node), so
+  // the signatures are reproducible for a given engine, independent of the
+  // number of threads.
+  std::optional<std::uint64_t> seed;
+
+  PushSampling pushSampling = PushSampling::Auto;
+  MajoritySampling majoritySampling = MajoritySampling::Neighbors;
+  Termination termination = Termination::Decided;
+  double flipEpsilon = 0.001; // Stable: quiet rounds flip < epsilon * n nodes
+  size_t patience = 5;
+  // Further alphas whose decisions an early stop has to leave unchanged, set
+  // by OverCoDe::sweep() while it generates signatures
+  std::vector<double> sweepAlphas;
+
+  // Anytime mode, off if batchRuns is 0: runs are generated in batches of
+  // batchRuns (rounded up to a multiple of 64), and the signatures are
+  // clustered after each batch. Generation stops after ell runs, once the
+  // clustering was the same after `stableBatches` consecutive batches, or
+  // once timeBudget seconds (if > 0) have passed.
+  size_t batchRuns = 0;
+  size_t stableBatches = 2;
+  double timeBudget = 0;
+
+  // Below 1, representatives are looked up in an LSH index (SignatureIndex)
+  // that finds a similar earlier representative with about this probability
+  // instead of comparing with all of them
+  double lshRecall = 1.0;
+
+  // Record the phase times and counts of every run, see RunProfile.h
+  bool profile = false;
+  // Receives a timeline of the tasks and phases of the runs if set, see
+  // Trace.h
+  Tracer *tracer = nullptr;
+
+  Parallelism parallelism = Parallelism::Auto;
+  // Threads of the pool OverCoDe creates when it is not given one.
+  // 0: one per hardware thread
+  size_t threads = 0;
+};
+
+#endif // OVERCODEOPTIONS_H_INCLUDED
@@ -0,0 +1,295 @@
+#ifndef PIPELINE_H_INCLUDED
+#define PIPELINE_H_INCLUDED
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+/**
+ * First-in first-out queue between pipeline stages. push() waits while the
+ * queue holds `capacity` items and pop() while it is empty; once closed,
+ * push() drops its item and pop() drains what is left.
+ */
+template <class T> class BoundedQueue {
+public:
+  explicit BoundedQueue(const size_t capacity)
+      : limit(capacity > 0 ? capacity : 1) {}
+
+  // false if the queue was closed and the item dropped
+  bool push(T item) {
+    std::unique_lock<std::mutex> lock(mtx);
+    notFull.wait(lock, [this]() { return closed || items.size() < limit; });
+    if (closed) {
+      return false;
+    }
+    items.push_back(std::move(item));
+    notEmpty.notify_one();
+    return true;
+  }
+
+  // Waits until push() would not wait; false if the queue was closed
+  bool waitForSpace() {
+    std::unique_lock<std::mutex> lock(mtx);
+    notFull.wait(lock, [this]() { return closed || items.size() < limit; });
+    return !closed;
+  }
+
+  // Empty once the queue is closed and drained
+  std::optional<T> pop() {
+    std::unique_lock<std::mutex> lock(mtx);
+    notEmpty.wait(lock, [this]() { return closed || !items.empty(); });
+    if (items.empty()) {
+      return std::nullopt;
+    }
+    T item = std::move(items.front());
+    items.pop_front();
+    notFull.notify_one();
+    return item;
+  }
+
+  void close() {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      closed = true;
+    }
+    notFull.notify_all();
+    notEmpty.notify_all();
+  }
+
+private:
+  const size_t limit;
+  std::mutex mtx;
+  std::condition_variable notFull;
+  std::condition_variable notEmpty;
+  std::deque<T> items;
+  bool closed = false;
+};
+
+/**
+ * Produces produce(0), ..., produce(count - 1) on a background thread, at
+ * most `ahead` items before they are taken, counting the one in production.
+ * An exception of produce() ends the stage and is rethrown by next().
+ */
+template <class T> class Prefetcher {
+public:
+  Prefetcher(const size_t count, const size_t ahead,
+             std::function<T(size_t)> produce)
+      : queue(ahead), thread([this, count, produce = std::move(produce)]() {
+          try {
+            for (size_t i = 0; i < count && queue.waitForSpace() &&
+                               queue.push(produce(i));
+                 i++) {
+            }
+          } catch (...) {
+            error = std::current_exception();
+          }
+          queue.close();
+        }) {}
+
+  // Waits for an item that was not produced yet to finish, if any
+  ~Prefetcher() {
+    queue.close();
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+  Prefetcher(const Prefetcher &) = delete;
+  Prefetcher &operator=(const Prefetcher &) = delete;
+
+  // The next item, in order
+  T next() {
+    std::optional<T> item = queue.pop();
+    if (!item) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+      if (error) {
+        std::rethrow_exception(error);
+      }
+      throw std::out_of_range("no items left to prefetch");
+    }
+    return std::move(*item);
+  }
+
+private:
+  BoundedQueue<T> queue;
+  std::exception_ptr error; // written before the queue is closed
+  std::thread thread;
+};
+
+/**
+ * Runs jobs on a background thread, one after another in the order they
+ * were added. After a job throws, the remaining ones are dropped and the
+ * exception is rethrown by the following add() or finish().
+ */
+class SerialStage {
+public:
+  explicit SerialStage(const size_t queuedJobs = 64)
+      : queue(queuedJobs), thread([this]() { runAll(); }) {}
+
+  ~SerialStage() {
+    if (thread.joinable()) {
+      queue.close();
+      thread.join();
+    }
+  }
+
+  SerialStage(const SerialStage &) = delete;
+  SerialStage &operator=(const SerialStage &) = delete;
+
+  void add(std::function<void()> job) {
+    rethrow();
+    queue.push(std::move(job));
+  }
+
+  // Runs everything added so far
+  void finish() {
+    if (thread.joinable()) {
+      queue.close();
+      thread.join();
+    }
+    rethrow();
+  }
+
+private:
+  BoundedQueue<std::function<void()>> queue;
+  std::mutex errorMtx;
+  std::exception_ptr error;
+  std::thread thread;
+
+  void runAll() {
+    while (std::optional<std::function<void()>> job = queue.pop()) {
+      {
+        std::lock_guard<std::mutex> lock(errorMtx);
+        if (error) {
+          continue; // drain, so that add() never waits for nothing
+        }
+      }
+      try {
+        (*job)();
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMtx);
+        error = std::current_exception();
+      }
+    }
+  }
+
+  void rethrow() {
+    std::lock_guard<std::mutex> lock(errorMtx);
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+};
+
+/**
+ * Appends text to files on a background thread. Every file is opened once,
+ * in append mode with a large buffer, and closed by finish(). A failed
+ * write is rethrown by the following append() or finish().
+ */
+class FileWriter {
+public:
+  static constexpr size_t BUFFER_BYTES = 1 << 20;
+
+  explicit FileWriter(const size_t queuedBlocks = 64)
+      : queue(queuedBlocks), thread([this]() { writeAll(); }) {}
+
+  ~FileWriter() {
+    if (thread.joinable()) {
+      queue.close();
+      thread.join();
+    }
+  }
+
+  FileWriter(const FileWriter &) = delete;
+  FileWriter &operator=(const FileWriter &) = delete;
+
+  void append(const std::string &filename, std::string text) {
+    rethrow();
+    queue.push({filename, std::move(text)});
+  }
+
+  // Writes everything appended so far and closes the files
+  void finish() {
+    if (thread.joinable()) {
+      queue.close();
+      thread.join();
+    }
+    rethrow();
+  }
+
+private:
+  struct File {
+    std::unique_ptr<char[]> buffer;
+    std::ofstream out;
+  };
+
+  BoundedQueue<std::pair<std::string, std::string>> queue;
+  std::mutex errorMtx;
+  std::exception_ptr error;
+  std::thread thread;
+
+  void writeAll() {
+    std::map<std::string, File> files;
+    while (std::optional<std::pair<std::string, std::string>> block =
+               queue.pop()) {
+      if (failed()) {
+        continue; // drain, so that append() never waits for nothing
+      }
+      try {
+        File &file = files[block->first];
+        if (!file.buffer) {
+          file.buffer = std::make_unique<char[]>(BUFFER_BYTES);
+          file.out.rdbuf()->pubsetbuf(file.buffer.get(), BUFFER_BYTES);
+          file.out.open(block->first, std::ios::app);
+        }
+        if (!file.out.write(block->second.data(),
+                            static_cast<std::streamsize>(
+                                block->second.size()))) {
+          throw std::runtime_error("cannot write '" + block->first + "'");
+        }
+      } catch (...) {
+        fail(std::current_exception());
+      }
+    }
+    for (auto &[name, file] : files) {
+      if (!file.out.flush() && !failed()) {
+        fail(std::make_exception_ptr(
+            std::runtime_error("cannot write '" + name + "'")));
+      }
+    }
+  }
+
+  bool failed() {
+    std::lock_guard<std::mutex> lock(errorMtx);
+    return error != nullptr;
+  }
+
+  void fail(std::exception_ptr e) {
+    std::lock_guard<std::mutex> lock(errorMtx);
+    if (!error) {
+      error = std::move(e);
+    }
+  }
+
+  void rethrow() {
+    std::lock_guard<std::mutex> lock(errorMtx);
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+};
+
+#endif // PIPELINE_H_INCLUDED
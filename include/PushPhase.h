@@ -0,0 +1,54 @@
+#ifndef PUSHPHASE_H_INCLUDED
+#define PUSHPHASE_H_INCLUDED
+
+#include <cstdint>
+#include <vector>
+
+#include "CSRGraph.h"
+#include "OverCoDeOptions.h"
+#include "RandomGenerator.h"
+
+// Fewest pushes per neighbor for which PushSampling::Auto prefers the
+// multinomial over individual draws. An individual draw costs a few ns, a
+// cell of the multinomial a few dozen whatever its mean; BM_PushTokens
+// (bench/bench_RANDOMGENERATOR.cpp) puts the break-even at about 32.
+constexpr int MULTINOMIAL_MIN_PUSHES_PER_NEIGHBOR = 32;
+
+inline bool useMultinomial(const PushSampling sampling, const int k_dist,
+                           const size_t degree) {
+  switch (sampling) {
+  case PushSampling::Exact:
+    return false;
+  case PushSampling::Multinomial:
+    return true;
+  default:
+    return static_cast<std::uint64_t>(k_dist) >=
+           MULTINOMIAL_MIN_PUSHES_PER_NEIGHBOR * std::uint64_t{degree};
+  }
+}
+
+/**
+ * Step 1 of the symmetry breaking for one node: sends k_dist copies of its
+ * token (val = +1 for R, -1 for B) to neighbors chosen uniformly at random,
+ * adding them to their inbox entries. Both samplings give the same
+ * distribution of inbox counts. neighbors must not be empty.
+ */
+template <class Stream>
+void pushTokens(const CSRView::Neighbors &neighbors, const int k_dist,
+                const int val, const PushSampling sampling,
+                std::vector<int> &inbox, Stream &stream) {
+  const auto sz = static_cast<std::uint32_t>(neighbors.size());
+  if (!useMultinomial(sampling, k_dist, neighbors.size())) {
+    for (int i = 0; i < k_dist; ++i) {
+      inbox[neighbors[stream.bounded(sz)]] += val;
+    }
+    return;
+  }
+
+  uniformMultinomial(stream, static_cast<std::uint32_t>(k_dist), sz,
+                     [&](const std::uint32_t i, const std::uint32_t count) {
+                       inbox[neighbors[i]] += val * static_cast<int>(count);
+                     });
+}
+
+#endif // PUSHPHASE_H_INCLUDED
@@ -1,6 +1,10 @@
 #ifndef RANDOMGENERATOR_H_INCLUDED
 #define RANDOMGENERATOR_H_INCLUDED
 
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <random> // For mt19937 and uniform distributions
 #include <stdexcept>
@@ -80,4 +84,396 @@ private:
 inline thread_local RandomGenerator
     rng; // global declaration for multithreading
 
+// Fast generators for the hot loops. All of them produce 32-bit words through
+// next32(), unbiased bounded integers through bounded() and can be
+// positioned at the start of the draws of a (run, round, node) triple, so
+// the kernels are written once as templates over the generator type.
+
+// SplitMix64 step, used to expand a single seed into generator state
+inline std::uint64_t splitMix64(std::uint64_t &state) {
+  std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/**
+ * Maps the 32-bit random word x to [0, range) with Lemire's multiply-shift.
+ * The rare draws that would bias the result are rejected and replaced by new
+ * words from gen, so the result is exactly uniform. range must be > 0.
+ */
+template <class Generator>
+std::uint32_t lemireBounded(std::uint32_t x, const std::uint32_t range,
+                            Generator &gen) {
+  std::uint64_t m = static_cast<std::uint64_t>(x) * range;
+  auto low = static_cast<std::uint32_t>(m);
+  if (low < range) {
+    const std::uint32_t threshold = (0U - range) % range;
+    while (low < threshold) {
+      x = gen.next32();
+      m = static_cast<std::uint64_t>(x) * range;
+      low = static_cast<std::uint32_t>(m);
+    }
+  }
+  return static_cast<std::uint32_t>(m >> 32);
+}
+
+// xoshiro256++ (Blackman and Vigna), a UniformRandomBitGenerator
+class Xoshiro256pp {
+public:
+  using result_type = std::uint64_t;
+
+  explicit Xoshiro256pp(std::uint64_t seed) {
+    for (std::uint64_t &word : state) {
+      word = splitMix64(seed);
+    }
+  }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  result_type operator()() {
+    const std::uint64_t result = rotl(state[0] + state[3], 23) + state[0];
+    const std::uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 45);
+    return result;
+  }
+
+private:
+  std::uint64_t state[4];
+
+  static std::uint64_t rotl(const std::uint64_t x, const int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+};
+
+// Philox4x32-10 block function (Salmon et al., Random123)
+struct Philox4x32 {
+  using Counter = std::array<std::uint32_t, 4>;
+  using Key = std::array<std::uint32_t, 2>;
+
+  static Counter generate(Counter counter, Key key) {
+    for (int round = 0; round < 10; round++) {
+      const std::uint64_t product0 =
+          static_cast<std::uint64_t>(0xD2511F53U) * counter[0];
+      const std::uint64_t product1 =
+          static_cast<std::uint64_t>(0xCD9E8D57U) * counter[2];
+      counter = {static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^
+                     key[0],
+                 static_cast<std::uint32_t>(product1),
+                 static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^
+                     key[1],
+                 static_cast<std::uint32_t>(product0)};
+      key[0] += 0x9E3779B9U;
+      key[1] += 0xBB67AE85U;
+    }
+    return counter;
+  }
+};
+
+/**
+ * Generator for the hot loops when no seed is requested. One xoshiro256++
+ * stream per worker; position() is a no-op.
+ */
+class SequentialStream {
+public:
+  explicit SequentialStream(const std::uint64_t seed) : gen(seed) {}
+
+  void position(std::uint64_t /*run*/, std::uint32_t /*round*/,
+                std::uint32_t /*node*/) {}
+
+  // UniformRandomBitGenerator interface, for the standard distributions
+  using result_type = std::uint64_t;
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+  result_type operator()() { return next64(); }
+
+  std::uint64_t next64() { return gen(); }
+
+  std::uint32_t next32() {
+    if (spareBits) {
+      spareBits = false;
+      return static_cast<std::uint32_t>(spare >> 32);
+    }
+    spare = gen();
+    spareBits = true;
+    return static_cast<std::uint32_t>(spare);
+  }
+
+  void fill(std::uint32_t *out, const size_t count) {
+    size_t i = 0;
+    for (; i + 1 < count; i += 2) {
+      const std::uint64_t word = gen();
+      out[i] = static_cast<std::uint32_t>(word);
+      out[i + 1] = static_cast<std::uint32_t>(word >> 32);
+    }
+    if (i < count) {
+      out[i] = next32();
+    }
+  }
+
+  std::uint32_t bounded(const std::uint32_t range) {
+    return lemireBounded(next32(), range, *this);
+  }
+
+private:
+  Xoshiro256pp gen;
+  std::uint64_t spare = 0;
+  bool spareBits = false;
+};
+
+/**
+ * Counter-based generator for reproducible runs. After position(run, round,
+ * node) the draws only depend on the seed and that triple, so a run gives the
+ * same result no matter which thread executes it or how many there are.
+ */
+class CounterStream {
+public:
+  explicit CounterStream(const std::uint64_t seed)
+      : key{static_cast<std::uint32_t>(seed),
+            static_cast<std::uint32_t>(seed >> 32)} {}
+
+  void position(const std::uint64_t run, const std::uint32_t round,
+                const std::uint32_t node) {
+    counter = {static_cast<std::uint32_t>(run), round, node, 0};
+    available = 0;
+  }
+
+  std::uint32_t next32() {
+    if (available == 0) {
+      block = Philox4x32::generate(counter, key);
+      counter[3]++;
+      available = 4;
+    }
+    return block[4 - available--];
+  }
+
+  // UniformRandomBitGenerator interface, for the standard distributions
+  using result_type = std::uint64_t;
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+  result_type operator()() { return next64(); }
+
+  std::uint64_t next64() {
+    const std::uint64_t low = next32();
+    return low | (static_cast<std::uint64_t>(next32()) << 32);
+  }
+
+  void fill(std::uint32_t *out, const size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      out[i] = next32();
+    }
+  }
+
+  std::uint32_t bounded(const std::uint32_t range) {
+    return lemireBounded(next32(), range, *this);
+  }
+
+private:
+  Philox4x32::Key key;
+  Philox4x32::Counter counter{};
+  Philox4x32::Counter block{};
+  size_t available = 0;
+};
+
+// Uniform double in [0, 1) from the top 53 bits of a draw
+template <class Stream> double uniformUnit(Stream &stream) {
+  return static_cast<double>(stream.next64() >> 11) * 0x1.0p-53;
+}
+
+// Mean from which binomial() switches from inversion to btrsBinomial()
+constexpr double BINOMIAL_INVERSION_MAX_MEAN = 10.0;
+
+namespace detail {
+
+// log(k!) minus its Stirling approximation
+// (k + 1/2) log(k + 1) - (k + 1) + log(2π) / 2
+inline double stirlingTail(const double k) {
+  static constexpr double TAIL[10] = {
+      0.0810614667953272,  0.0413406959554092,  0.0276779256849983,
+      0.02079067210376509, 0.0166446911898211,  0.0138761288230707,
+      0.0118967099458917,  0.0104112652619720,  0.00925546218271273,
+      0.00833056343336287};
+  if (k <= 9) {
+    return TAIL[static_cast<int>(k)];
+  }
+  const double next = (k + 1) * (k + 1);
+  return (1.0 / 12 - (1.0 / 360 - 1.0 / 1260 / next) / next) / (k + 1);
+}
+
+} // namespace detail
+
+/**
+ * Binomial draw by transformed rejection with squeeze (BTRS, Hörmann 1993)
+ * for trials * p >= 10 and p <= 1/2. A candidate costs two uniforms and is
+ * accepted by the squeeze most of the time; only the others evaluate the
+ * probability mass function. The setup is a square root and a few
+ * divisions, so a draw costs O(1) independent of the mean.
+ */
+template <class Stream>
+std::uint32_t btrsBinomial(Stream &stream, const std::uint32_t trials,
+                           const double p) {
+  const double n = trials;
+  const double q = 1.0 - p;
+  const double spq = std::sqrt(n * p * q);
+  const double b = 1.15 + 2.53 * spq;
+  const double a = -0.0873 + 0.0248 * b + 0.01 * p;
+  const double c = n * p + 0.5;
+  const double vr = 0.92 - 4.2 / b;
+
+  while (true) {
+    const double u = uniformUnit(stream) - 0.5;
+    double v = uniformUnit(stream);
+    const double us = 0.5 - std::fabs(u);
+    const double k = std::floor((2 * a / us + b) * u + c);
+    if (k < 0 || k > n) {
+      continue;
+    }
+    if (us >= 0.07 && v <= vr) {
+      return static_cast<std::uint32_t>(k);
+    }
+
+    // Compare with the mass function relative to the mode m
+    const double alpha = (2.83 + 5.1 / b) * spq;
+    const double r = p / q;
+    const double m = std::floor((n + 1) * p);
+    v = std::log(v * alpha / (a / (us * us) + b));
+    const double bound =
+        (m + 0.5) * std::log((m + 1) / (r * (n - m + 1))) +
+        (n + 1) * std::log((n - m + 1) / (n - k + 1)) +
+        (k + 0.5) * std::log(r * (n - k + 1) / (k + 1)) +
+        detail::stirlingTail(m) + detail::stirlingTail(n - m) -
+        detail::stirlingTail(k) - detail::stirlingTail(n - k);
+    if (v <= bound) {
+      return static_cast<std::uint32_t>(k);
+    }
+  }
+}
+
+/**
+ * Number of successes in `trials` Bernoulli trials with probability p.
+ * Means below BINOMIAL_INVERSION_MAX_MEAN are sampled by inversion, walking
+ * the probability mass function from 0 with a single uniform draw, which
+ * takes about mean + 1 steps. Larger ones use btrsBinomial(), so every call
+ * costs O(1). Unlike std::binomial_distribution, the draws of a stream do
+ * not depend on the standard library.
+ */
+template <class Stream>
+std::uint32_t binomial(Stream &stream, const std::uint32_t trials,
+                       const double p) {
+  if (trials == 0 || p <= 0.0) {
+    return 0;
+  }
+  if (p >= 1.0) {
+    return trials;
+  }
+  const double mean = static_cast<double>(trials) * p;
+  if (mean >= BINOMIAL_INVERSION_MAX_MEAN) {
+    // BTRS needs p <= 1/2, count the failures otherwise
+    return p <= 0.5 ? btrsBinomial(stream, trials, p)
+                    : trials - binomial(stream, trials, 1.0 - p);
+  }
+
+  const double odds = p / (1.0 - p);
+  double mass = std::exp(static_cast<double>(trials) * std::log1p(-p));
+  double u = uniformUnit(stream);
+  std::uint32_t x = 0;
+  while (u >= mass && x < trials) {
+    u -= mass;
+    mass *= odds * static_cast<double>(trials - x) / static_cast<double>(x + 1);
+    x++;
+  }
+  return x;
+}
+
+/**
+ * Throws `trials` balls into `cells` equally likely cells and calls
+ * visit(cell, count) for every cell that received count > 0 balls. The
+ * multinomial counts are drawn as a chain of binomials conditioned on the
+ * balls left. Each binomial() costs O(1), so the cost is O(cells) instead of
+ * O(trials).
+ */
+template <class Stream, class Visit>
+void uniformMultinomial(Stream &stream, std::uint32_t trials,
+                        const std::uint32_t cells, Visit visit) {
+  for (std::uint32_t cell = 0; cell < cells && trials > 0; cell++) {
+    const std::uint32_t left = cells - cell;
+    const std::uint32_t count =
+        left == 1 ? trials : binomial(stream, trials, 1.0 / left);
+    if (count > 0) {
+      visit(cell, count);
+      trials -= count;
+    }
+  }
+}
+
+/**
+ * Calls emit(i) for every i in [0, count) independently with probability p.
+ * Instead of a coin flip per index, the gap to the next emitted index is
+ * drawn from the geometric distribution (Batagelj and Brandes), so the cost
+ * is proportional to the number of emitted indices.
+ */
+template <class Stream, class Emit>
+void bernoulliIndices(Stream &stream, const std::uint64_t count,
+                      const double p, Emit emit) {
+  if (p <= 0.0) {
+    return;
+  }
+  if (p >= 1.0) {
+    for (std::uint64_t i = 0; i < count; i++) {
+      emit(i);
+    }
+    return;
+  }
+  const double logMiss = std::log1p(-p);
+  double next = -1.0; // in double, so a huge gap cannot overflow
+  while (true) {
+    next += 1.0 + std::floor(std::log1p(-uniformUnit(stream)) / logMiss);
+    if (next >= static_cast<double>(count)) {
+      return;
+    }
+    emit(static_cast<std::uint64_t>(next));
+  }
+}
+
+// bernoulliIndices() over the unordered pairs of [0, size), calling
+// emit(w, v) with w < v
+template <class Stream, class Emit>
+void bernoulliPairs(Stream &stream, const std::uint64_t size, const double p,
+                    Emit emit) {
+  std::uint64_t v = 1;        // pairs are enumerated row by row
+  std::uint64_t rowStart = 0; // index of the pair (0, v)
+  const std::uint64_t pairs = size < 2 ? 0 : size * (size - 1) / 2;
+  bernoulliIndices(stream, pairs, p, [&](const std::uint64_t i) {
+    while (i >= rowStart + v) {
+      rowStart += v;
+      v++;
+    }
+    emit(i - rowStart, v);
+  });
+}
+
+// Round ids the signature kernels position their streams at. Round 0 draws
+// the initial tokens, the pushes get their own id, and round t >= 1 of the
+// process (pull at t = 1, ρ-majority from t = 2) uses t + 1.
+struct StreamRound {
+  static constexpr std::uint32_t INIT = 0;
+  static constexpr std::uint32_t PUSH = 1;
+
+  static std::uint32_t of(const size_t t) {
+    return static_cast<std::uint32_t>(t + 1);
+  }
+};
+
 #endif // RANDOMGENERATOR_H_INCLUDED
@@ -0,0 +1,244 @@
+#ifndef RUNPROFILE_H_INCLUDED
+#define RUNPROFILE_H_INCLUDED
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Trace.h"
+
+// Phases of a run that are timed
+enum class Phase {
+  Graph,           // generating or loading the graph
+  Push,            // initial tokens and the k pushes of symmetry breaking
+  Pull,            // the h samples of symmetry breaking
+  Majority,        // ρ-majority rounds, including the stopping checks
+  Tally,           // turning the R tallies into signatures
+  Purity,          // decided counts and the pure signatures
+  Representatives, // clustersIDs()
+  Assignment       // comparing every node with the representatives
+};
+constexpr size_t PHASE_COUNT = 8;
+
+inline const char *phaseName(const Phase phase) {
+  static const char *const names[PHASE_COUNT] = {
+      "graph", "push",   "pull",            "majority",
+      "tally", "purity", "representatives", "assignment"};
+  return names[static_cast<size_t>(phase)];
+}
+
+/**
+ * Counters of one thread: seconds spent in every phase and, for every
+ * ρ-majority round, the runs that executed it and the tokens that flipped
+ * in it over those runs. Round r (1 .. T) is at index r - 1.
+ */
+struct PhaseCounters {
+  std::array<double, PHASE_COUNT> seconds{};
+  std::vector<std::uint64_t> roundRuns;
+  std::vector<std::uint64_t> roundFlips;
+
+  void add(const Phase phase, const double s) {
+    seconds[static_cast<size_t>(phase)] += s;
+  }
+
+  void addRound(const size_t round, const std::uint64_t runs,
+                const std::uint64_t flips) {
+    if (roundRuns.size() < round) {
+      roundRuns.resize(round, 0);
+      roundFlips.resize(round, 0);
+    }
+    roundRuns[round - 1] += runs;
+    roundFlips[round - 1] += flips;
+  }
+
+  void merge(const PhaseCounters &other) {
+    for (size_t p = 0; p < PHASE_COUNT; p++) {
+      seconds[p] += other.seconds[p];
+    }
+    for (size_t r = 0; r < other.roundRuns.size(); r++) {
+      addRound(r + 1, other.roundRuns[r], other.roundFlips[r]);
+    }
+  }
+};
+
+// Seconds on the steady clock since `start`
+inline double secondsSince(const std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// Charges the steady clock time since the previous charge (or construction)
+// to a phase, and records it as an event of the tracer. Does nothing without
+// counters and tracer.
+class PhaseTimer {
+public:
+  explicit PhaseTimer(PhaseCounters *phaseCounters,
+                      Tracer *phaseTracer = nullptr)
+      : counters(phaseCounters), tracer(phaseTracer) {
+    if (counters != nullptr || tracer != nullptr) {
+      last = std::chrono::steady_clock::now();
+    }
+  }
+
+  void charge(const Phase phase) {
+    if (counters == nullptr && tracer == nullptr) {
+      return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (counters != nullptr) {
+      counters->add(phase, std::chrono::duration<double>(now - last).count());
+    }
+    if (tracer != nullptr) {
+      tracer->record(phaseName(phase), last, now);
+    }
+    last = now;
+  }
+
+private:
+  PhaseCounters *counters;
+  Tracer *tracer;
+  std::chrono::steady_clock::time_point last;
+};
+
+/**
+ * Measurements of one run of OverCoDe. Worker threads count into their own
+ * slot of `workers`, so their phase seconds add up to thread-seconds,
+ * including the time spent waiting at barriers; the phases of the calling
+ * thread (graph, clustering) are wall clock seconds. The two are kept apart,
+ * see wall() and threads().
+ */
+struct RunProfile {
+  std::vector<PhaseCounters> workers;
+  PhaseCounters caller;
+
+  double signatureSeconds = 0; // wall clock of the signature generation
+  double totalSeconds = 0;     // wall clock of the whole run
+  size_t nodes = 0;
+  size_t runs = 0;      // columns of the signatures
+  size_t pureNodes = 0; // nodes with a pure signature
+  size_t clusters = 0;
+  std::uint64_t undecided = 0; // undecided entries of the signatures
+
+  // Sum of the caller's and all workers' counters
+  PhaseCounters total() const {
+    PhaseCounters sum = caller;
+    sum.merge(threads());
+    return sum;
+  }
+
+  // Wall clock seconds of the phases the calling thread ran
+  const PhaseCounters &wall() const { return caller; }
+
+  // Thread-seconds of the phases, summed over the workers
+  PhaseCounters threads() const {
+    PhaseCounters sum;
+    for (const PhaseCounters &worker : workers) {
+      sum.merge(worker);
+    }
+    return sum;
+  }
+
+  double undecidedFraction() const {
+    return nodes * runs == 0 ? 0.0
+                             : static_cast<double>(undecided) /
+                                   static_cast<double>(nodes * runs);
+  }
+};
+
+/**
+ * Appends one record per (graph, run) to a file: a CSV row if the name ends
+ * in ".csv", else a JSON object per line that also holds the runs and flips
+ * of every round. Wall clock seconds (`wall_seconds`, `<phase>_wall_s`) and
+ * worker thread-seconds (`thread_seconds`, `<phase>_thread_s`) are written
+ * separately; only the former are comparable with the total.
+ */
+class ProfileWriter {
+public:
+  explicit ProfileWriter(const std::string &filename)
+      : csv(filename.size() >= 4 &&
+            filename.compare(filename.size() - 4, 4, ".csv") == 0),
+        out(filename, std::ios::trunc) {
+    if (!out) {
+      throw std::runtime_error("cannot write '" + filename + "'");
+    }
+    out.precision(9);
+    if (csv) {
+      out << "graph,run,nodes,runs,total_s,signatures_s";
+      for (const char *const clock : {"_wall_s", "_thread_s"}) {
+        for (size_t p = 0; p < PHASE_COUNT; p++) {
+          out << "," << phaseName(static_cast<Phase>(p)) << clock;
+        }
+      }
+      out << ",pure_nodes,clusters,undecided_fraction,rounds,flips\n";
+    }
+  }
+
+  void write(const RunProfile &profile, const int graph, const int run) {
+    const PhaseCounters total = profile.total();
+    const PhaseCounters &wall = profile.wall();
+    const PhaseCounters threads = profile.threads();
+    if (csv) {
+      std::uint64_t flips = 0;
+      for (const std::uint64_t f : total.roundFlips) {
+        flips += f;
+      }
+      out << graph << "," << run << "," << profile.nodes << ","
+          << profile.runs << "," << profile.totalSeconds << ","
+          << profile.signatureSeconds;
+      for (const double s : wall.seconds) {
+        out << "," << s;
+      }
+      for (const double s : threads.seconds) {
+        out << "," << s;
+      }
+      out << "," << profile.pureNodes << "," << profile.clusters << ","
+          << profile.undecidedFraction() << "," << total.roundRuns.size()
+          << "," << flips << "\n";
+    } else {
+      out << "{\"graph\":" << graph << ",\"run\":" << run
+          << ",\"nodes\":" << profile.nodes << ",\"runs\":" << profile.runs
+          << ",\"wall_seconds\":{\"total\":" << profile.totalSeconds
+          << ",\"signatures\":" << profile.signatureSeconds;
+      writePhases(wall, false);
+      out << "},\"thread_seconds\":{";
+      writePhases(threads, true);
+      out << "},\"pure_nodes\":" << profile.pureNodes
+          << ",\"clusters\":" << profile.clusters
+          << ",\"undecided_fraction\":" << profile.undecidedFraction()
+          << ",\"round_runs\":";
+      writeArray(total.roundRuns);
+      out << ",\"round_flips\":";
+      writeArray(total.roundFlips);
+      out << "}\n";
+    }
+    out.flush();
+  }
+
+private:
+  bool csv;
+  std::ofstream out;
+
+  // "<phase>":seconds for every phase, comma separated
+  void writePhases(const PhaseCounters &counters, bool first) {
+    for (size_t p = 0; p < PHASE_COUNT; p++) {
+      out << (first ? "" : ",") << "\"" << phaseName(static_cast<Phase>(p))
+          << "\":" << counters.seconds[p];
+      first = false;
+    }
+  }
+
+  void writeArray(const std::vector<std::uint64_t> &values) {
+    out << "[";
+    for (size_t i = 0; i < values.size(); i++) {
+      out << (i == 0 ? "" : ",") << values[i];
+    }
+    out << "]";
+  }
+};
+
+#endif // RUNPROFILE_H_INCLUDED
@@ -0,0 +1,83 @@
+#ifndef RUNTALLIES_H_INCLUDED
+#define RUNTALLIES_H_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "BitOps.h"
+#include "SignatureMatrix.h"
+#include "StoppingRule.h"
+#include "ThreadPool.h"
+
+/**
+ * Number of rounds every node spent as R in every run, one row per node and
+ * one column per run. A node's signature at any alpha follows from its row
+ * alone, see decide().
+ */
+class RunTallies {
+public:
+  // rowCount rows of `length` runs with T_dist rounds each, all zero
+  void reset(const size_t rowCount, const size_t length, const size_t T_dist) {
+    if (T_dist > std::numeric_limits<std::uint16_t>::max()) {
+      throw std::invalid_argument("too many rounds to store their tallies");
+    }
+    numRows = rowCount;
+    runs = length;
+    rounds = T_dist;
+    tallies.assign(numRows * runs, 0);
+  }
+
+  size_t rows() const { return numRows; }
+  size_t length() const { return runs; }
+
+  // Writers of different entries do not interfere
+  void set(const size_t row, const size_t run, const std::uint64_t tallyR) {
+    tallies[row * runs + run] = static_cast<std::uint16_t>(tallyR);
+  }
+
+  std::uint64_t get(const size_t row, const size_t run) const {
+    return tallies[row * runs + run];
+  }
+
+  /**
+   * Fills signatures with the decisions at alpha_dist, as the engines take
+   * them: R with a tally of at least alpha * T, else B with at most
+   * (1 - alpha) * T, else undecided.
+   */
+  void decide(const double alpha_dist, SignatureMatrix &signatures,
+              ThreadPool &pool) const {
+    const std::uint64_t minRed = StoppingRule::minRedFor(alpha_dist, rounds);
+    signatures.reset(numRows, runs);
+    pool.parallelFor(numRows, [&](const size_t u) {
+      const std::uint16_t *row = &tallies[u * runs];
+      for (size_t w = 0; w * bits::WORD_BITS < runs; w++) {
+        std::uint64_t decided = 0;
+        std::uint64_t blue = 0;
+        const size_t end = std::min(runs, (w + 1) * bits::WORD_BITS);
+        for (size_t run = w * bits::WORD_BITS; run < end; run++) {
+          const std::uint64_t bit = std::uint64_t{1}
+                                    << (run % bits::WORD_BITS);
+          if (row[run] >= minRed) {
+            decided |= bit;
+          } else if (minRed <= rounds && row[run] <= rounds - minRed) {
+            decided |= bit;
+            blue |= bit;
+          }
+        }
+        signatures.setWord(u, w, decided, blue);
+      }
+    });
+  }
+
+private:
+  size_t numRows = 0;
+  size_t runs = 0;
+  size_t rounds = 0;
+  std::vector<std::uint16_t> tallies;
+};
+
+#endif // RUNTALLIES_H_INCLUDED
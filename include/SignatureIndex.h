@@ -0,0 +1,98 @@
+#ifndef SIGNATUREINDEX_H_INCLUDED
+#define SIGNATUREINDEX_H_INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "BitOps.h"
+#include "RandomGenerator.h"
+#include "SignatureMatrix.h"
+
+/**
+ * Bit-sampling LSH over signatures for the similarity() of
+ * SignatureMatrix.h. Every table hashes a signature to the colours at a few
+ * fixed random positions, so two signatures agreeing on a fraction s of the
+ * positions share a bucket with probability about s^bits. Undecided
+ * positions hash as R, which lowers the collision rate of pairs with many of
+ * them.
+ *
+ * The number of bits per table is chosen so that a pair at the similarity
+ * threshold collides in a table with probability about 0.3. The number of
+ * tables is the smallest that lets such a pair share at least one bucket with
+ * probability `recall`.
+ */
+class SignatureIndex {
+public:
+  static constexpr size_t MAX_TABLES = 64;
+
+  SignatureIndex(const size_t length, const double threshold,
+                 const double recall) {
+    const double s = std::min(std::max(threshold, 0.01), 0.99);
+    bitsPerTable = static_cast<size_t>(
+        std::clamp(std::floor(std::log(0.3) / std::log(s)), 1.0, 32.0));
+    const double hit = std::pow(s, static_cast<double>(bitsPerTable));
+    const double target = std::min(std::max(recall, 0.0), 0.999999);
+    tableCount = static_cast<size_t>(std::clamp(
+        std::ceil(std::log1p(-target) / std::log1p(-hit)), 1.0,
+        static_cast<double>(MAX_TABLES)));
+
+    // The same positions for every index over signatures of this length
+    Xoshiro256pp gen(length);
+    positions.resize(tableCount * bitsPerTable);
+    for (size_t &position : positions) {
+      position = length == 0 ? 0 : static_cast<size_t>(gen() % length);
+    }
+    buckets.resize(tableCount);
+  }
+
+  size_t tables() const { return tableCount; }
+
+  // Bucket keys of a signature, one per table
+  void keys(const SignatureView &signature, std::uint32_t *out) const {
+    for (size_t table = 0; table < tableCount; table++) {
+      std::uint32_t key = 0;
+      for (size_t b = 0; b < bitsPerTable; b++) {
+        const size_t i = positions[table * bitsPerTable + b];
+        const std::uint64_t bit =
+            (signature.colour[i / bits::WORD_BITS] >> (i % bits::WORD_BITS)) &
+            1U;
+        key |= static_cast<std::uint32_t>(bit) << b;
+      }
+      out[table] = key;
+    }
+  }
+
+  // Adds entry id under the keys computed by keys()
+  void insert(const std::uint32_t id, const std::uint32_t *entryKeys) {
+    for (size_t table = 0; table < tableCount; table++) {
+      buckets[table][entryKeys[table]].push_back(id);
+    }
+  }
+
+  // Ids sharing at least one bucket with the given keys, sorted and unique
+  void candidates(const std::uint32_t *queryKeys,
+                  std::vector<std::uint32_t> &out) const {
+    out.clear();
+    for (size_t table = 0; table < tableCount; table++) {
+      const auto bucket = buckets[table].find(queryKeys[table]);
+      if (bucket != buckets[table].end()) {
+        out.insert(out.end(), bucket->second.begin(), bucket->second.end());
+      }
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+  }
+
+private:
+  size_t bitsPerTable = 1;
+  size_t tableCount = 1;
+  std::vector<size_t> positions; // bitsPerTable per table
+  std::vector<std::unordered_map<std::uint32_t, std::vector<std::uint32_t>>>
+      buckets;
+};
+
+#endif // SIGNATUREINDEX_H_INCLUDED
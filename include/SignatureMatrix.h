@@ -0,0 +1,299 @@
+#ifndef SIGNATUREMATRIX_H_INCLUDED
+#define SIGNATUREMATRIX_H_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__)
+// GCC 12 flags the placeholder operands inside its own AVX-512 intrinsics
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#else
+#include <immintrin.h>
+#endif
+#define OVERCODE_SIMILARITY_AVX512
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define OVERCODE_SIMILARITY_AVX2
+#endif
+
+#include "BitOps.h"
+
+/**
+ * Ternary signature packed into two bitplanes. Bit i of `decided` is set if
+ * run i produced a colour for the node, bit i of `colour` then holds it
+ * (0 = R, 1 = B). Undecided positions always have their colour bit cleared.
+ */
+struct SignatureView {
+  const std::uint64_t *decided;
+  const std::uint64_t *colour;
+  size_t words;
+};
+
+// Positions decided in both signatures, and how many of those agree
+struct SignatureOverlap {
+  std::uint64_t valid = 0;
+  std::uint64_t agree = 0;
+};
+
+namespace detail {
+
+#ifdef OVERCODE_SIMILARITY_AVX2
+// Per 64-bit lane popcount of a 256-bit vector (nibble lookup, Mula et al.)
+inline __m256i popcount256(const __m256i v) {
+  const __m256i lookup =
+      _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1,
+                       2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i lowNibbles = _mm256_set1_epi8(0x0f);
+  const __m256i low = _mm256_and_si256(v, lowNibbles);
+  const __m256i high = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowNibbles);
+  const __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low),
+                                         _mm256_shuffle_epi8(lookup, high));
+  return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+}
+
+inline std::uint64_t horizontalSum(const __m256i v) {
+  return static_cast<std::uint64_t>(_mm256_extract_epi64(v, 0)) +
+         static_cast<std::uint64_t>(_mm256_extract_epi64(v, 1)) +
+         static_cast<std::uint64_t>(_mm256_extract_epi64(v, 2)) +
+         static_cast<std::uint64_t>(_mm256_extract_epi64(v, 3));
+}
+#endif
+
+} // namespace detail
+
+/**
+ * valid = popcount(decidedA & decidedB)
+ * agree = popcount(decidedA & decidedB & ~(colourA ^ colourB))
+ * Uses AVX-512 or AVX2 when the compiler targets them (see
+ * ENABLE_NATIVE_ARCH), the remaining words go through scalar popcounts.
+ */
+inline SignatureOverlap compareSignatures(const SignatureView &a,
+                                          const SignatureView &b) {
+  SignatureOverlap overlap;
+  size_t w = 0;
+
+#if defined(OVERCODE_SIMILARITY_AVX512)
+  __m512i valid = _mm512_setzero_si512();
+  __m512i agree = _mm512_setzero_si512();
+  for (; w + 8 <= a.words; w += 8) {
+    const __m512i both = _mm512_and_si512(_mm512_loadu_si512(a.decided + w),
+                                          _mm512_loadu_si512(b.decided + w));
+    const __m512i differ = _mm512_xor_si512(_mm512_loadu_si512(a.colour + w),
+                                            _mm512_loadu_si512(b.colour + w));
+    valid = _mm512_add_epi64(valid, _mm512_popcnt_epi64(both));
+    agree = _mm512_add_epi64(
+        agree, _mm512_popcnt_epi64(_mm512_andnot_si512(differ, both)));
+  }
+  overlap.valid += static_cast<std::uint64_t>(_mm512_reduce_add_epi64(valid));
+  overlap.agree += static_cast<std::uint64_t>(_mm512_reduce_add_epi64(agree));
+#elif defined(OVERCODE_SIMILARITY_AVX2)
+  __m256i valid = _mm256_setzero_si256();
+  __m256i agree = _mm256_setzero_si256();
+  for (; w + 4 <= a.words; w += 4) {
+    const auto load = [w](const std::uint64_t *p) {
+      return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + w));
+    };
+    const __m256i both = _mm256_and_si256(load(a.decided), load(b.decided));
+    const __m256i differ = _mm256_xor_si256(load(a.colour), load(b.colour));
+    valid = _mm256_add_epi64(valid, detail::popcount256(both));
+    agree = _mm256_add_epi64(
+        agree, detail::popcount256(_mm256_andnot_si256(differ, both)));
+  }
+  overlap.valid += detail::horizontalSum(valid);
+  overlap.agree += detail::horizontalSum(agree);
+#endif
+
+  for (; w < a.words; w++) {
+    const std::uint64_t both = a.decided[w] & b.decided[w];
+    overlap.valid += bits::popcount(both);
+    overlap.agree += bits::popcount(both & ~(a.colour[w] ^ b.colour[w]));
+  }
+  return overlap;
+}
+
+/**
+ * Fraction of the positions decided in both signatures on which they agree,
+ * 0 if there is no such position.
+ * vec1:  R B B U R U B
+ * vec2:  B B R U R B B
+ * valid: 1 1 1 0 1 0 1
+ * agree: 0 1 0 0 1 0 1
+ * gives 3 / 5
+ */
+inline double similarity(const SignatureView &a, const SignatureView &b) {
+  const SignatureOverlap overlap = compareSignatures(a, b);
+  if (overlap.valid == 0) {
+    return 0.0; // Avoid division by zero if there are no valid indices
+  }
+  return static_cast<double>(overlap.agree) /
+         static_cast<double>(overlap.valid);
+}
+
+/**
+ * similarity(a, b) >= threshold, where maxValid bounds the number of
+ * positions decided in both (e.g. the smaller decided count). The words are
+ * compared in blocks, and the scan stops once the disagreements alone rule
+ * out the threshold: a similar pair disagrees on at most
+ * (1 - threshold) * valid <= (1 - threshold) * maxValid positions.
+ */
+inline bool isSimilar(const SignatureView &a, const SignatureView &b,
+                      const double threshold, const std::uint64_t maxValid) {
+  constexpr size_t BLOCK_WORDS = 4;
+  if (maxValid == 0) {
+    return false; // similarity() is 0 without common decided positions
+  }
+  const double maxDisagree =
+      (1.0 - threshold) * static_cast<double>(maxValid) + 1e-9;
+  SignatureOverlap overlap;
+  for (size_t w = 0; w < a.words; w += BLOCK_WORDS) {
+    const size_t count = std::min(BLOCK_WORDS, a.words - w);
+    const SignatureOverlap block =
+        compareSignatures({a.decided + w, a.colour + w, count},
+                          {b.decided + w, b.colour + w, count});
+    overlap.valid += block.valid;
+    overlap.agree += block.agree;
+    if (static_cast<double>(overlap.valid - overlap.agree) > maxDisagree) {
+      return false;
+    }
+  }
+  return overlap.valid != 0 && static_cast<double>(overlap.agree) /
+                                       static_cast<double>(overlap.valid) >=
+                                   threshold;
+}
+
+/**
+ * Node-major store of ternary signatures, one row per node and one column per
+ * run. Each row occupies the same number of words in both bitplanes, so the
+ * 2 bits of an entry are found at the same word and bit in either plane.
+ */
+class SignatureMatrix {
+public:
+  SignatureMatrix() = default;
+  SignatureMatrix(const size_t rowCount, const size_t length) {
+    reset(rowCount, length);
+  }
+
+  // Resizes to rowCount signatures of the given length, all undecided
+  void reset(const size_t rowCount, const size_t length) {
+    numRows = rowCount;
+    signatureLength = length;
+    rowWords = bits::wordsFor(length);
+    decided.assign(numRows * rowWords, 0);
+    colour.assign(numRows * rowWords, 0);
+  }
+
+  size_t rows() const { return numRows; }
+  size_t length() const { return signatureLength; }
+  size_t wordsPerRow() const { return rowWords; }
+
+  // Stores value (-1 undecided, 0 R, 1 B) at position i of a row
+  void set(const size_t row, const size_t i, const int value) {
+    const size_t word = row * rowWords + i / bits::WORD_BITS;
+    const std::uint64_t bit = std::uint64_t{1} << (i % bits::WORD_BITS);
+    if (value < 0) {
+      decided[word] &= ~bit;
+      colour[word] &= ~bit;
+    } else if (value <= 1) {
+      decided[word] |= bit;
+      if (value == 1) {
+        colour[word] |= bit;
+      } else {
+        colour[word] &= ~bit;
+      }
+    } else {
+      throw std::invalid_argument("signature values must be -1, 0 or 1");
+    }
+  }
+
+  // set() for writers that share words with other writers, such as tasks
+  // storing different runs of the same row at once: the bits are changed
+  // with atomic read-modify-writes instead of plain loads and stores
+  void setShared(const size_t row, const size_t i, const int value) {
+    if (value < -1 || value > 1) {
+      throw std::invalid_argument("signature values must be -1, 0 or 1");
+    }
+    const size_t word = row * rowWords + i / bits::WORD_BITS;
+    const std::uint64_t bit = std::uint64_t{1} << (i % bits::WORD_BITS);
+    atomicAssign(decided[word], bit, value >= 0);
+    atomicAssign(colour[word], bit, value == 1);
+  }
+
+  // Stores the 64 positions held by word w of a row at once, bit j standing
+  // for position 64 * w + j. Writers of different rows, or of different
+  // words of a row, do not interfere.
+  void setWord(const size_t row, const size_t w,
+               const std::uint64_t decidedBits,
+               const std::uint64_t colourBits) {
+    decided[row * rowWords + w] = decidedBits;
+    colour[row * rowWords + w] = colourBits & decidedBits;
+  }
+
+  // Value at position i of a row: -1 undecided, 0 R, 1 B
+  int value(const size_t row, const size_t i) const {
+    const size_t word = row * rowWords + i / bits::WORD_BITS;
+    const size_t shift = i % bits::WORD_BITS;
+    if (((decided[word] >> shift) & 1U) == 0) {
+      return -1;
+    }
+    return static_cast<int>((colour[word] >> shift) & 1U);
+  }
+
+  // Number of decided positions of a row
+  size_t decidedCount(const size_t row) const {
+    size_t count = 0;
+    for (size_t w = 0; w < rowWords; w++) {
+      count += bits::popcount(decided[row * rowWords + w]);
+    }
+    return count;
+  }
+
+  SignatureView row(const size_t r) const {
+    return {decided.data() + r * rowWords, colour.data() + r * rowWords,
+            rowWords};
+  }
+
+  std::vector<int> unpack(const size_t r) const {
+    return unpack(r, signatureLength);
+  }
+
+  // The first `count` positions of a row
+  std::vector<int> unpack(const size_t r, const size_t count) const {
+    std::vector<int> signature(count);
+    for (size_t i = 0; i < count; i++) {
+      signature[i] = value(r, i);
+    }
+    return signature;
+  }
+
+private:
+  static void atomicAssign(std::uint64_t &word, const std::uint64_t bit,
+                           const bool on) {
+#if defined(__GNUC__) || defined(__clang__)
+    if (on) {
+      __atomic_fetch_or(&word, bit, __ATOMIC_RELAXED);
+    } else {
+      __atomic_fetch_and(&word, ~bit, __ATOMIC_RELAXED);
+    }
+#else
+    static std::mutex lock;
+    std::lock_guard<std::mutex> guard(lock);
+    word = on ? word | bit : word & ~bit;
+#endif
+  }
+
+  size_t numRows = 0;
+  size_t signatureLength = 0;
+  size_t rowWords = 0;
+  std::vector<std::uint64_t> decided;
+  std::vector<std::uint64_t> colour;
+};
+
+#endif // SIGNATUREMATRIX_H_INCLUDED
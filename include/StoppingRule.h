@@ -0,0 +1,113 @@
+#ifndef STOPPINGRULE_H_INCLUDED
+#define STOPPINGRULE_H_INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "OverCoDeOptions.h"
+
+/**
+ * Decides when a run may end its ρ-majority rounds early. A node decides R
+ * if it spent at least minRed of the T rounds as R, otherwise B if it spent
+ * at most maxBlue rounds as R. Its decision is fixed once no tally the
+ * remaining rounds can reach changes it, so stopping when every decision is
+ * fixed gives the result of all T rounds.
+ *
+ * After an early stop the remaining rounds are assumed to repeat the last
+ * one. This never changes a fixed decision, and extrapolates the tallies of
+ * the nodes that are still open under Termination::Stable.
+ *
+ * With options.sweepAlphas a decision only counts as fixed once it is fixed
+ * for each of those alphas too, so the tallies decide all of them exactly.
+ */
+class StoppingRule {
+public:
+  StoppingRule(const OverCoDeOptions &options, const size_t T_dist,
+               const double alpha_dist)
+      : mode(options.termination), rounds(T_dist),
+        flipEpsilon(options.flipEpsilon), patience(options.patience) {
+    reds.push_back(minRedFor(alpha_dist, T_dist));
+    for (const double alpha : options.sweepAlphas) {
+      reds.push_back(minRedFor(alpha, T_dist));
+    }
+  }
+
+  // Smallest R tally out of T_dist rounds that decides R at alpha_dist
+  static std::uint64_t minRedFor(const double alpha_dist,
+                                 const size_t T_dist) {
+    const double threshold = alpha_dist * static_cast<double>(T_dist);
+    return static_cast<std::uint64_t>(std::max(0.0, std::ceil(threshold)));
+  }
+
+  // Smallest R tally that decides R
+  std::uint64_t minRed() const { return reds.front(); }
+
+  // minRed() followed by those of options.sweepAlphas
+  const std::vector<std::uint64_t> &minReds() const { return reds; }
+
+  bool checksDecisions() const { return mode != Termination::Full; }
+  bool countsFlips() const { return mode == Termination::Stable; }
+
+  // Whether a node that spent tallyR of the first `elapsed` rounds as R
+  // ends with the same decision whatever the remaining rounds are
+  bool isFixed(const std::uint64_t tallyR, const size_t elapsed) const {
+    for (const std::uint64_t red : reds) {
+      if (!isFixed(tallyR, elapsed, red)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // The same for the threshold red
+  bool isFixed(const std::uint64_t tallyR, const size_t elapsed,
+               const std::uint64_t red) const {
+    if (tallyR >= red) {
+      return true; // R, takes precedence
+    }
+    const std::uint64_t remaining = rounds - elapsed;
+    if (tallyR + remaining >= red) {
+      return false; // may still reach R
+    }
+    if (red > rounds) {
+      return true; // B is out of reach as well
+    }
+    const std::uint64_t maxBlue = rounds - red;
+    return tallyR + remaining <= maxBlue || tallyR > maxBlue;
+  }
+
+  /**
+   * Called by every member of a team after each round with the totals of
+   * the team: whether all decisions are fixed and how many of the n nodes
+   * flipped. Returns true if the run should stop.
+   */
+  bool stop(const size_t elapsed, const bool allFixed,
+            const std::uint64_t flips, const size_t n) {
+    if (elapsed >= rounds || mode == Termination::Full) {
+      return false;
+    }
+    if (allFixed) {
+      return true;
+    }
+    if (mode != Termination::Stable) {
+      return false;
+    }
+    const bool quiet =
+        static_cast<double>(flips) < flipEpsilon * static_cast<double>(n);
+    quietRounds = quiet ? quietRounds + 1 : 0;
+    return quietRounds >= patience;
+  }
+
+private:
+  Termination mode;
+  size_t rounds;
+  double flipEpsilon;
+  size_t patience;
+  std::vector<std::uint64_t> reds;
+  size_t quietRounds = 0;
+};
+
+#endif // STOPPINGRULE_H_INCLUDED
@@ -1,8 +1,14 @@
 #ifndef SYNTHETICEGOGRAPH_H
 #define SYNTHETICEGOGRAPH_H
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
 #include <vector>
 
+#include "EgoGraphParams.h"
 #include "Graph.h"
 #include "RandomGenerator.h"
 
@@ -10,105 +16,160 @@ class SyntheticEgoGraph final : public Graph {
 private:
   // stores which nodes are in which cluster
   RandomGenerator rng;
-
-  // Parameters
-  static constexpr int CLUSTER_MEAN_SIZE = 125;
-  static constexpr int CLUSTER_STD_DEV = 25;
-  static constexpr int MIN_OVERLAP_SIZE = 0;
-  static constexpr int MAX_OVERLAP_SIZE = 10;
-  static constexpr int MIN_INTERCLUSTER_EDGES = 10;
-  static constexpr int MAX_INTERCLUSTER_EDGES = 20;
+  EgoGraphParams params;
+
+  static constexpr std::uint32_t NO_CLUSTER =
+      std::numeric_limits<std::uint32_t>::max();
+
+  // The one or two clusters of every node but the ego node, which is in all
+  // of them and comes last
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> homes;
+  std::vector<std::pair<size_t, size_t>> linkedPairs;
+
+  // Pairs of clusters that overlap and get random edges between them
+  void drawLinkedPairs() {
+    linkedPairs.clear();
+    SequentialStream stream(rng.getRandomUll(0, ~0ULL));
+    bernoulliPairs(stream, clusters.size(), params.pairProbability,
+                   [this](const std::uint64_t i, const std::uint64_t j) {
+                     linkedPairs.emplace_back(i, j);
+                   });
+  }
 
   void addNodes() {
     // counter for what node we are considering
     size_t usedNodes = 0;
+    homes.clear();
 
     // add pure (non-overlapping) nodes to clusters
-    for (auto &cluster : clusters) {
-      const size_t clusterSize = static_cast<size_t>(
-          rng.getNormalInt(CLUSTER_MEAN_SIZE, CLUSTER_STD_DEV));
+    for (size_t c = 0; c < clusters.size(); c++) {
+      const size_t clusterSize = static_cast<size_t>(std::max(
+          0, rng.getNormalInt(params.clusterMeanSize, params.clusterStdDev)));
       for (size_t j = usedNodes; j < (usedNodes + clusterSize); j++) {
-        cluster.push_back(j);
+        clusters[c].push_back(j);
+        homes.emplace_back(static_cast<std::uint32_t>(c), NO_CLUSTER);
       }
       usedNodes += clusterSize;
     }
 
-    // add overlapping nodes to clusters
-
-    // all possible combinations of r clusters
-    for (size_t i = 0; i < clusters.size(); i++) {
-      for (size_t j = i + 1; j < clusters.size(); j++) {
-        const size_t overlapSize = static_cast<size_t>(
-            rng.getRandomInt(MIN_OVERLAP_SIZE, MAX_OVERLAP_SIZE));
-        for (size_t m = usedNodes; m < (usedNodes + overlapSize); m++) {
-          clusters[i].push_back(m);
-          clusters[j].push_back(m);
-        }
-        usedNodes += overlapSize;
+    // add overlapping nodes to the linked pairs of clusters
+    for (const auto &[i, j] : linkedPairs) {
+      const size_t overlapSize = static_cast<size_t>(
+          rng.getRandomInt(params.minOverlap, params.maxOverlap));
+      for (size_t m = usedNodes; m < (usedNodes + overlapSize); m++) {
+        clusters[i].push_back(m);
+        clusters[j].push_back(m);
+        homes.emplace_back(static_cast<std::uint32_t>(i),
+                           static_cast<std::uint32_t>(j));
       }
+      usedNodes += overlapSize;
     }
 
-    // add ego Node once to a ll clusters
+    // add ego Node once to all clusters
     for (std::vector<unsigned long long> &cluster : clusters) {
       cluster.push_back(usedNodes);
     }
   }
 
-public:
-  SyntheticEgoGraph() = default;
-
-  void generateGraph() override {
-    clusters.resize(static_cast<size_t>(rng.getRandomInt(4, 6)));
-    addNodes();
-
-    size_t graphSize = 0;
-
-    for (const auto &cluster : clusters) {
-      graphSize += cluster.size();
+  // Lowest cluster containing both u and v, NO_CLUSTER if there is none
+  std::uint32_t firstCommonCluster(const size_t u, const size_t v) const {
+    const size_t ego = homes.size();
+    if (u == ego || v == ego) {
+      return u == v ? 0 : homes[u == ego ? v : u].first;
     }
+    const auto [u1, u2] = homes[u];
+    const auto [v1, v2] = homes[v];
+    std::uint32_t common = NO_CLUSTER;
+    for (const std::uint32_t c : {u1, u2}) {
+      if (c != NO_CLUSTER && (c == v1 || c == v2)) {
+        common = std::min(common, c);
+      }
+    }
+    return common;
+  }
 
-    adjList.resize(graphSize);
-
-    std::vector<std::vector<bool>>
-        connected; // this stores nodes we have connected already, so that we do
-                   // not connect nodes in the overlap > 1 time
-    connected.resize(graphSize, std::vector<bool>(graphSize));
-
-    // completely connect clusters internally
-
-    for (auto &cluster : clusters) {
+  /**
+   * Calls emit(u, v) once for every edge: the cliques of the clusters, where
+   * a pair in several clusters belongs to the lowest of them, followed by
+   * the random edges between linked clusters.
+   */
+  template <class Emit>
+  void forEachEdge(const std::vector<std::pair<NodeId, NodeId>> &interEdges,
+                   Emit emit) const {
+    for (size_t c = 0; c < clusters.size(); c++) {
+      const std::vector<unsigned long long> &cluster = clusters[c];
       for (size_t j = 0; j < cluster.size(); j++) {
         for (size_t m = j + 1; m < cluster.size(); m++) {
-          if (!connected[cluster[m]][cluster[j]]) {
-            connected[cluster[j]][cluster[m]] = true;
-            connected[cluster[m]][cluster[j]] = true;
-            adjList[cluster[j]].push_back(cluster[m]);
-            adjList[cluster[m]].push_back(cluster[j]);
+          if (firstCommonCluster(cluster[j], cluster[m]) == c) {
+            emit(static_cast<NodeId>(cluster[j]),
+                 static_cast<NodeId>(cluster[m]));
           }
         }
       }
     }
+    for (const auto &[u, v] : interEdges) {
+      emit(u, v);
+    }
+  }
 
-    // add 10-20 edges between any 2 pairs of clusters
-    for (size_t i = 0; i < clusters.size(); i++) {
-      for (size_t j = i + 1; j < clusters.size(); j++) {
-        const int edgeCount =
-            rng.getRandomInt(MIN_INTERCLUSTER_EDGES, MAX_INTERCLUSTER_EDGES);
-        for (int m = 0; m < edgeCount; m++) {
-          unsigned long long addToI =
-              clusters[i][rng.getRandomUll(0, clusters[i].size() - 1)];
-          unsigned long long addToJ =
-              clusters[j][rng.getRandomUll(0, clusters[j].size() - 1)];
-
-          if (!connected[addToI][addToJ]) {
-            connected[addToI][addToJ] = true;
-            connected[addToJ][addToI] = true;
-            adjList[addToI].push_back(addToJ);
-            adjList[addToJ].push_back(addToI);
-          }
+  // Random edges between linked clusters that are not clique edges already,
+  // each at most once
+  std::vector<std::pair<NodeId, NodeId>> drawInterEdges() {
+    std::vector<std::pair<NodeId, NodeId>> edges;
+    for (const auto &[i, j] : linkedPairs) {
+      const int edgeCount =
+          rng.getRandomInt(params.minInterEdges, params.maxInterEdges);
+      for (int m = 0; m < edgeCount; m++) {
+        const unsigned long long addToI =
+            clusters[i][rng.getRandomUll(0, clusters[i].size() - 1)];
+        const unsigned long long addToJ =
+            clusters[j][rng.getRandomUll(0, clusters[j].size() - 1)];
+        if (firstCommonCluster(addToI, addToJ) == NO_CLUSTER) {
+          edges.emplace_back(static_cast<NodeId>(std::min(addToI, addToJ)),
+                             static_cast<NodeId>(std::max(addToI, addToJ)));
         }
       }
     }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    return edges;
+  }
+
+public:
+  explicit SyntheticEgoGraph(const EgoGraphParams &shape = EgoGraphParams())
+      : params(shape) {}
+
+  /**
+   * Every edge is produced exactly once, so the adjacency is filled in place
+   * from exact degree counts: one pass counts, a second one fills.
+   */
+  void generateGraph() override {
+    clusters.assign(static_cast<size_t>(rng.getRandomUll(
+                        params.minClusters, params.maxClusters)),
+                    {});
+    drawLinkedPairs();
+    addNodes();
+    const std::vector<std::pair<NodeId, NodeId>> interEdges =
+        drawInterEdges();
+    const size_t graphSize = homes.size() + 1;
+
+    std::vector<std::uint64_t> offsets(graphSize + 1, 0);
+    forEachEdge(interEdges, [&offsets](const NodeId u, const NodeId v) {
+      ++offsets[u + 1];
+      ++offsets[v + 1];
+    });
+    for (size_t u = 0; u < graphSize; ++u) {
+      offsets[u + 1] += offsets[u];
+    }
+
+    std::vector<NodeId> neighbors(static_cast<size_t>(offsets[graphSize]));
+    std::vector<std::uint64_t> cursor(offsets.begin(), offsets.end() - 1);
+    forEachEdge(interEdges, [&](const NodeId u, const NodeId v) {
+      neighbors[static_cast<size_t>(cursor[u]++)] = v;
+      neighbors[static_cast<size_t>(cursor[v]++)] = u;
+    });
+
+    adjList = CSRGraph::fromRows(std::move(offsets), std::move(neighbors));
   }
 
   std::vector<std::vector<unsigned long long>> getClusters() const {
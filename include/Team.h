@@ -0,0 +1,137 @@
+#ifndef TEAM_H_INCLUDED
+#define TEAM_H_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Reusable barrier for a fixed number of threads. Waiters spin briefly before
+// blocking, since the phases of a run are usually short.
+class Barrier {
+private:
+  std::mutex mtx;
+  std::condition_variable cv;
+  const size_t parties;
+  size_t waiting = 0;
+  std::atomic<size_t> generation{0};
+
+  static constexpr int SPIN_LIMIT = 4096;
+
+public:
+  explicit Barrier(const size_t threads) : parties(threads) {}
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(mtx);
+    const size_t arrivedIn = generation.load(std::memory_order_relaxed);
+    if (++waiting == parties) {
+      waiting = 0;
+      generation.fetch_add(1, std::memory_order_release);
+      cv.notify_all();
+      return;
+    }
+    lock.unlock();
+    for (int i = 0; i < SPIN_LIMIT; i++) {
+      if (generation.load(std::memory_order_acquire) != arrivedIn) {
+        return;
+      }
+      std::this_thread::yield();
+    }
+    lock.lock();
+    cv.wait(lock, [this, arrivedIn]() {
+      return generation.load(std::memory_order_acquire) != arrivedIn;
+    });
+  }
+};
+
+/**
+ * The threads cooperating on a single run. Each member knows its rank and
+ * works on its share of the nodes; sync() separates the phases of a run.
+ * A team of size one never synchronizes.
+ */
+struct Team {
+  size_t rank = 0;
+  size_t size = 1;
+  Barrier *barrier = nullptr;
+
+  void sync() const {
+    if (barrier != nullptr) {
+      barrier->wait();
+    }
+  }
+
+  // This member's contiguous share [first, second) of `total` items
+  std::pair<size_t, size_t> range(const size_t total) const {
+    const size_t chunk = total / size;
+    const size_t extra = total % size;
+    const size_t begin = rank * chunk + std::min(rank, extra);
+    return {begin, begin + chunk + (rank < extra ? 1 : 0)};
+  }
+};
+
+/**
+ * A count summed over the members of a team, once per round. Every member
+ * writes its part, and after a sync all members read the same total. The
+ * slots alternate between rounds, so a member may write the next round while
+ * the others still read the current one.
+ */
+class TeamSum {
+public:
+  void resize(const size_t members) {
+    slots[0].resize(members);
+    slots[1].resize(members);
+  }
+
+  std::uint64_t &part(const size_t round, const size_t rank) {
+    return slots[round % 2][rank];
+  }
+
+  std::uint64_t total(const size_t round) const {
+    std::uint64_t sum = 0;
+    for (const std::uint64_t value : slots[round % 2]) {
+      sum += value;
+    }
+    return sum;
+  }
+
+private:
+  std::vector<std::uint64_t> slots[2];
+};
+
+// How the worker threads are split: `teams` runs in parallel, each executed
+// by `teamSize` threads
+struct TeamPlan {
+  size_t teams = 1;
+  size_t teamSize = 1;
+};
+
+// Fewest nodes per thread that make splitting a run worthwhile
+constexpr size_t MIN_NODES_PER_THREAD = 4096;
+
+/**
+ * Chooses between run-level parallelism (one thread per task), node-level
+ * parallelism (all threads on one task) and a hybrid of both. Cores left
+ * idle by too few tasks are given to the tasks as long as every thread still
+ * gets MIN_NODES_PER_THREAD nodes.
+ */
+inline TeamPlan planTeams(const size_t nodes, const size_t tasks,
+                          const size_t threads, const bool allowNodeLevel) {
+  TeamPlan plan;
+  if (tasks == 0 || threads == 0) {
+    return plan;
+  }
+  plan.teams = std::min(tasks, threads);
+  if (!allowNodeLevel || tasks >= threads) {
+    return plan;
+  }
+  const size_t maxTeamSize = std::max<size_t>(1, nodes / MIN_NODES_PER_THREAD);
+  plan.teamSize = std::min(threads / plan.teams, maxTeamSize);
+  return plan;
+}
+
+#endif // TEAM_H_INCLUDED
@@ -0,0 +1,275 @@
+#ifndef THREADPOOL_H_INCLUDED
+#define THREADPOOL_H_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#include "Team.h"
+#include "Trace.h"
+
+/**
+ * Objects of any default constructible type, at most one per type, created
+ * on first use and kept for the lifetime of the arena. Buffers stored in
+ * them keep their capacity from one use to the next.
+ */
+class ScratchArena {
+public:
+  template <class T> T &get() {
+    std::shared_ptr<void> &slot = objects[std::type_index(typeid(T))];
+    if (!slot) {
+      slot = std::make_shared<T>();
+    }
+    return *static_cast<T *>(slot.get());
+  }
+
+private:
+  std::unordered_map<std::type_index, std::shared_ptr<void>> objects;
+};
+
+/**
+ * Persistent pool of worker threads. Every worker owns a task deque: it
+ * takes tasks from the back of its own and, once that is empty, steals from
+ * the front of the others'. The thread that submits work helps with it
+ * until it is done, so size() counts the calling thread as well.
+ *
+ * Work is submitted from one thread at a time; a pool task that submits
+ * work to its own pool runs it inline.
+ */
+class ThreadPool {
+public:
+  // threads = 0: one per hardware thread
+  explicit ThreadPool(const size_t threads = 0)
+      : threadCount(defaultThreads(threads)), arenas(threadCount) {
+    queues.reserve(threadCount - 1);
+    for (size_t i = 0; i + 1 < threadCount; i++) {
+      queues.push_back(std::make_unique<Queue>());
+    }
+    workers.reserve(threadCount - 1);
+    for (size_t i = 0; i + 1 < threadCount; i++) {
+      workers.emplace_back([this, i]() { work(i); });
+    }
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(sleepMtx);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  size_t size() const { return threadCount; }
+
+  // Scratch objects of slot i < size(), e.g. of the i-th team of a call to
+  // concurrently(). The slot belongs to whoever the caller hands it to.
+  ScratchArena &arena(const size_t slot) { return arenas[slot]; }
+
+  // Records every chunk of parallelFor() and every call of concurrently()
+  // that runs on the pool as an event, if set. Set while no work runs.
+  void setTracer(Tracer *eventTracer) { tracer = eventTracer; }
+
+  /**
+   * Calls fn(i) for every i in [0, count). The indices are split into
+   * chunks of consecutive indices, which idle threads steal from each other.
+   */
+  template <class Fn> void parallelFor(const size_t count, Fn fn) {
+    const size_t chunks = std::min(count, threadCount * CHUNKS_PER_THREAD);
+    if (chunks <= 1 || queues.empty() || insideTask()) {
+      for (size_t i = 0; i < count; i++) {
+        fn(i);
+      }
+      return;
+    }
+    std::atomic<size_t> open{chunks};
+    for (size_t chunk = 0; chunk < chunks; chunk++) {
+      const auto [begin, end] = Team{chunk, chunks, nullptr}.range(count);
+      submit(chunk, [this, &fn, &open, chunk, begin = begin, end = end]() {
+        {
+          TraceScope scope(tracer, "chunk", "chunk", chunk);
+          for (size_t i = begin; i < end; i++) {
+            fn(i);
+          }
+        }
+        open.fetch_sub(1, std::memory_order_acq_rel);
+      });
+    }
+    help(open);
+  }
+
+  /**
+   * Calls fn(rank) for every rank in [0, count) on count different threads
+   * at the same time, so the calls may wait for each other (see Barrier).
+   * The calling thread takes rank 0. Requires count <= size().
+   */
+  template <class Fn> void concurrently(const size_t count, Fn fn) {
+    if (count > threadCount || (count > 1 && insideTask())) {
+      throw std::logic_error("not enough free threads in the pool");
+    }
+    std::atomic<size_t> open{count > 0 ? count - 1 : 0};
+    for (size_t rank = 1; rank < count; rank++) {
+      submit(rank - 1, [this, &fn, &open, rank]() {
+        {
+          TraceScope scope(tracer, "member", "rank", rank);
+          fn(rank);
+        }
+        open.fetch_sub(1, std::memory_order_acq_rel);
+      });
+    }
+    if (count > 0) {
+      TraceScope scope(tracer, "member", "rank", 0);
+      fn(0);
+    }
+    help(open);
+  }
+
+private:
+  struct Queue {
+    std::mutex mtx;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  static constexpr size_t CHUNKS_PER_THREAD = 4;
+
+  const size_t threadCount;
+  std::vector<ScratchArena> arenas;
+  std::vector<std::unique_ptr<Queue>> queues; // one per worker
+  std::vector<std::thread> workers;
+
+  std::mutex sleepMtx;
+  std::condition_variable wake;
+  std::atomic<size_t> pending{0}; // queued tasks not taken yet
+  bool stopping = false;
+  Tracer *tracer = nullptr;
+
+  static size_t defaultThreads(const size_t threads) {
+    const size_t hw = std::thread::hardware_concurrency();
+    return threads > 0 ? threads : (hw > 0 ? hw : 4);
+  }
+
+  // The pool whose task the current thread is executing, if any
+  static const ThreadPool *&currentPool() {
+    static thread_local const ThreadPool *pool = nullptr;
+    return pool;
+  }
+
+  bool insideTask() const { return currentPool() == this; }
+
+  void submit(const size_t slot, std::function<void()> task) {
+    Queue &queue = *queues[slot % queues.size()];
+    {
+      std::lock_guard<std::mutex> lock(queue.mtx);
+      queue.tasks.push_back(std::move(task));
+    }
+    pending.fetch_add(1, std::memory_order_release);
+    {
+      std::lock_guard<std::mutex> lock(sleepMtx);
+    }
+    wake.notify_all();
+  }
+
+  // Takes a task from the back of queue `own` (if it is a worker's), or
+  // steals one from the front of another queue
+  bool take(const size_t own, std::function<void()> &task) {
+    if (own < queues.size()) {
+      Queue &queue = *queues[own];
+      std::lock_guard<std::mutex> lock(queue.mtx);
+      if (!queue.tasks.empty()) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        pending.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+      }
+    }
+    for (size_t i = 1; i <= queues.size(); i++) {
+      Queue &queue = *queues[(own + i) % queues.size()];
+      std::lock_guard<std::mutex> lock(queue.mtx);
+      if (!queue.tasks.empty()) {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        pending.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // The submitting thread runs queued tasks until `open` drops to zero
+  void help(const std::atomic<size_t> &open) {
+    const ThreadPool *outer = currentPool();
+    currentPool() = this;
+    std::function<void()> task;
+    while (open.load(std::memory_order_acquire) > 0) {
+      if (take(queues.size(), task)) {
+        task();
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    currentPool() = outer;
+  }
+
+  void work(const size_t self) {
+    currentPool() = this;
+    std::function<void()> task;
+    while (true) {
+      if (take(self, task)) {
+        task();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleepMtx);
+      wake.wait(lock, [this]() {
+        return stopping || pending.load(std::memory_order_acquire) > 0;
+      });
+      if (stopping && pending.load(std::memory_order_acquire) == 0) {
+        return;
+      }
+    }
+  }
+};
+
+/**
+ * Sorts [first, last): the range is cut into one piece per thread (a power
+ * of two), the pieces are sorted in parallel and then merged pairwise, the
+ * merges of a level again in parallel.
+ */
+template <class It> void parallelSort(ThreadPool &pool, It first, It last) {
+  constexpr size_t MIN_PIECE = 1 << 16;
+  const auto count = static_cast<size_t>(last - first);
+  size_t pieces = 1;
+  while (pieces * 2 <= pool.size() && count / (pieces * 2) >= MIN_PIECE) {
+    pieces *= 2;
+  }
+  auto bound = [first, count, pieces](const size_t i) {
+    return first + static_cast<std::ptrdiff_t>(count * i / pieces);
+  };
+  pool.parallelFor(pieces, [&](const size_t i) {
+    std::sort(bound(i), bound(i + 1));
+  });
+  for (size_t width = 1; width < pieces; width *= 2) {
+    pool.parallelFor(pieces / (2 * width), [&](const size_t pair) {
+      const size_t left = pair * 2 * width;
+      std::inplace_merge(bound(left), bound(left + width),
+                         bound(left + 2 * width));
+    });
+  }
+}
+
+#endif // THREADPOOL_H_INCLUDED
@@ -0,0 +1,206 @@
+#ifndef TRACE_H_INCLUDED
+#define TRACE_H_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Interval a thread spent on something; names and argument names are
+// string literals
+struct TraceEvent {
+  const char *name = nullptr;
+  const char *argName = nullptr; // no argument if null
+  std::uint64_t arg = 0;
+  std::uint64_t beginNs = 0; // since the tracer was created
+  std::uint64_t endNs = 0;
+};
+
+/**
+ * Events of a single thread. Only that thread records, without locking;
+ * once full, the oldest events are overwritten. The events are read after
+ * the recording threads synchronized with the reader.
+ */
+class TraceRing {
+public:
+  TraceRing(const size_t capacity, const size_t threadIndex,
+            const std::thread::id thread)
+      : events(capacity), index(threadIndex), owner(thread) {}
+
+  void record(const TraceEvent &event) {
+    events[recorded % events.size()] = event;
+    recorded++;
+  }
+
+  // Events still held, oldest first
+  std::vector<TraceEvent> ordered() const {
+    const size_t held = std::min<std::uint64_t>(recorded, events.size());
+    std::vector<TraceEvent> out;
+    out.reserve(held);
+    for (std::uint64_t e = recorded - held; e < recorded; e++) {
+      out.push_back(events[e % events.size()]);
+    }
+    return out;
+  }
+
+  std::uint64_t dropped() const {
+    return recorded > events.size() ? recorded - events.size() : 0;
+  }
+  size_t thread() const { return index; }
+  std::thread::id threadId() const { return owner; }
+
+private:
+  std::vector<TraceEvent> events;
+  std::uint64_t recorded = 0;
+  size_t index;
+  std::thread::id owner;
+};
+
+/**
+ * Collects a timeline of the threads that record into it, one ring of
+ * `capacity` events per thread, and writes it in the Chrome Trace Event
+ * format (chrome://tracing, ui.perfetto.dev).
+ */
+class Tracer {
+public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  explicit Tracer(const size_t capacity = 1 << 16)
+      : eventsPerThread(std::max<size_t>(capacity, 1)), id(nextId()),
+        origin(std::chrono::steady_clock::now()) {}
+
+  Tracer(const Tracer &) = delete;
+  Tracer &operator=(const Tracer &) = delete;
+
+  std::uint64_t nanosSince(const TimePoint time) const {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(time - origin)
+            .count());
+  }
+
+  // Records an interval of the calling thread
+  void record(const char *name, const TimePoint begin, const TimePoint end,
+              const char *argName = nullptr, const std::uint64_t arg = 0) {
+    ring().record({name, argName, arg, nanosSince(begin), nanosSince(end)});
+  }
+
+  // Writes all events; no thread may record meanwhile
+  void write(const std::string &filename) const {
+    std::ofstream out(filename, std::ios::trunc);
+    if (!out) {
+      throw std::runtime_error("cannot write '" + filename + "'");
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    std::uint64_t dropped = 0;
+    const char *separator = "\n";
+    out << "{\"traceEvents\":[";
+    for (const auto &ring : rings) {
+      out << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+          << "\"tid\":" << ring->thread() << ",\"args\":{\"name\":\"thread "
+          << ring->thread() << "\"}}";
+      separator = ",\n";
+      for (const TraceEvent &event : ring->ordered()) {
+        out << separator << "{\"name\":\"" << event.name
+            << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->thread()
+            << ",\"ts\":" << micros(event.beginNs)
+            << ",\"dur\":" << micros(event.endNs - event.beginNs);
+        if (event.argName != nullptr) {
+          out << ",\"args\":{\"" << event.argName << "\":" << event.arg
+              << "}";
+        }
+        out << "}";
+      }
+      dropped += ring->dropped();
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":"
+        << dropped << "}}\n";
+    if (!out.flush()) {
+      throw std::runtime_error("cannot write '" + filename + "'");
+    }
+  }
+
+private:
+  const size_t eventsPerThread;
+  const std::uint64_t id; // tells tracers apart in the per-thread cache
+  const TimePoint origin;
+  mutable std::mutex mtx; // guards rings
+  std::vector<std::unique_ptr<TraceRing>> rings;
+
+  static std::uint64_t nextId() {
+    static std::atomic<std::uint64_t> ids{1};
+    return ids.fetch_add(1);
+  }
+
+  // Ring of the calling thread; the lock is only taken when a thread
+  // switches tracers
+  TraceRing &ring() {
+    thread_local std::uint64_t cachedId = 0;
+    thread_local TraceRing *cached = nullptr;
+    if (cachedId == id) {
+      return *cached;
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    const std::thread::id self = std::this_thread::get_id();
+    cached = nullptr;
+    for (const auto &ring : rings) {
+      if (ring->threadId() == self) {
+        cached = ring.get();
+      }
+    }
+    if (cached == nullptr) {
+      rings.push_back(
+          std::make_unique<TraceRing>(eventsPerThread, rings.size(), self));
+      cached = rings.back().get();
+    }
+    cachedId = id;
+    return *cached;
+  }
+
+  // Microseconds with three decimals
+  static std::string micros(const std::uint64_t ns) {
+    std::string fraction = std::to_string(ns % 1000);
+    fraction.insert(0, 3 - fraction.size(), '0');
+    return std::to_string(ns / 1000) + "." + fraction;
+  }
+};
+
+// Records the lifetime of the scope as an event; does nothing without a
+// tracer
+class TraceScope {
+public:
+  TraceScope(Tracer *eventTracer, const char *eventName,
+             const char *eventArgName = nullptr, const std::uint64_t value = 0)
+      : tracer(eventTracer), name(eventName), argName(eventArgName),
+        arg(value) {
+    if (tracer != nullptr) {
+      begin = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~TraceScope() {
+    if (tracer != nullptr) {
+      tracer->record(name, begin, std::chrono::steady_clock::now(), argName,
+                     arg);
+    }
+  }
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  Tracer *tracer;
+  const char *name;
+  const char *argName;
+  std::uint64_t arg;
+  Tracer::TimePoint begin;
+};
+
+#endif // TRACE_H_INCLUDED
@@ -1,8 +1,4 @@
 #!/bin/bash
 
-for i in {91..93}
-do
-	./main false 0.$i 0.95 cltest_0-$i 1 1 10 0 1&
-done
-
-wait
+# One set of runs, clustered for every alpha (cltest_alpha0.9x_beta0.95)
+./main false 0.92 0.95 cltest 1 1 10 0 1 --sweep-alpha=0.91,0.92,0.93
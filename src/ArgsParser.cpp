@@ -1,17 +1,247 @@
 #include "ArgsParser.h"
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Parses "a:b" into a <= b
+template <class T>
+std::pair<T, T> parseRange(const std::string &value, const std::string &name) {
+  const size_t split = value.find(':');
+  if (split == std::string::npos) {
+    throw std::runtime_error("--" + name + " must be of the form a:b!");
+  }
+  const long long first = std::stoll(value.substr(0, split));
+  const long long second = std::stoll(value.substr(split + 1));
+  if (first < 0 || first > second) {
+    throw std::runtime_error("--" + name + " needs 0 <= a <= b!");
+  }
+  return {static_cast<T>(first), static_cast<T>(second)};
+}
+
+// Parses "x,y,..." into values in (0, 1]
+std::vector<double> parseFractions(const std::string &value,
+                                   const std::string &name) {
+  std::vector<double> values;
+  size_t start = 0;
+  while (start <= value.size()) {
+    const size_t comma = std::min(value.find(',', start), value.size());
+    values.push_back(std::stod(value.substr(start, comma - start)));
+    if (values.back() <= 0 || values.back() > 1) {
+      throw std::runtime_error("--" + name + " values must be in (0, 1]!");
+    }
+    start = comma + 1;
+  }
+  return values;
+}
+
+// Applies a single --name=value flag to params
+void parseFlag(const std::string &arg, AppParams &params) {
+  const size_t split = arg.find('=');
+  const std::string name = arg.substr(2, split - 2);
+  const std::string value =
+      (split == std::string::npos) ? "" : arg.substr(split + 1);
+
+  if (name == "engine") {
+    if (value == "scalar") {
+      params.options.engine = SignatureEngine::Scalar;
+    } else if (value == "bitsliced") {
+      params.options.engine = SignatureEngine::Bitsliced;
+    } else {
+      throw std::runtime_error("--engine must be scalar or bitsliced!");
+    }
+  } else if (name == "seed") {
+    params.options.seed = std::stoull(value);
+  } else if (name == "push") {
+    if (value == "auto") {
+      params.options.pushSampling = PushSampling::Auto;
+    } else if (value == "exact") {
+      params.options.pushSampling = PushSampling::Exact;
+    } else if (value == "multinomial") {
+      params.options.pushSampling = PushSampling::Multinomial;
+    } else {
+      throw std::runtime_error("--push must be auto, exact or multinomial!");
+    }
+  } else if (name == "majority") {
+    if (value == "neighbors") {
+      params.options.majoritySampling = MajoritySampling::Neighbors;
+    } else if (value == "counts") {
+      params.options.majoritySampling = MajoritySampling::Counts;
+    } else {
+      throw std::runtime_error("--majority must be neighbors or counts!");
+    }
+  } else if (name == "termination") {
+    if (value == "full") {
+      params.options.termination = Termination::Full;
+    } else if (value == "decided") {
+      params.options.termination = Termination::Decided;
+    } else if (value == "stable") {
+      params.options.termination = Termination::Stable;
+    } else {
+      throw std::runtime_error(
+          "--termination must be full, decided or stable!");
+    }
+  } else if (name == "flip-epsilon") {
+    params.options.flipEpsilon = std::stod(value);
+    if (params.options.flipEpsilon < 0 || params.options.flipEpsilon > 1) {
+      throw std::runtime_error("--flip-epsilon must be between 0 and 1!");
+    }
+  } else if (name == "patience") {
+    params.options.patience = std::stoul(value);
+    if (params.options.patience == 0) {
+      throw std::runtime_error("--patience must be at least 1!");
+    }
+  } else if (name == "batch") {
+    params.options.batchRuns = std::stoul(value);
+  } else if (name == "stable-batches") {
+    // stoll, since stoul wraps negative values around
+    const long long batches = std::stoll(value);
+    if (batches < 1) {
+      throw std::runtime_error("--stable-batches must be at least 1!");
+    }
+    params.options.stableBatches = static_cast<size_t>(batches);
+  } else if (name == "time-budget") {
+    params.options.timeBudget = std::stod(value);
+    if (params.options.timeBudget < 0) {
+      throw std::runtime_error("--time-budget must be at least 0!");
+    }
+  } else if (name == "lsh-recall") {
+    params.options.lshRecall = std::stod(value);
+    if (params.options.lshRecall <= 0 || params.options.lshRecall > 1) {
+      throw std::runtime_error("--lsh-recall must be in (0, 1]!");
+    }
+  } else if (name == "parallelism") {
+    if (value == "auto") {
+      params.options.parallelism = Parallelism::Auto;
+    } else if (value == "runs") {
+      params.options.parallelism = Parallelism::Runs;
+    } else if (value == "nodes") {
+      params.options.parallelism = Parallelism::Nodes;
+    } else {
+      throw std::runtime_error("--parallelism must be auto, runs or nodes!");
+    }
+  } else if (name == "threads") {
+    params.options.threads = std::stoul(value);
+  } else if (name == "sweep-alpha") {
+    params.sweepAlphas = parseFractions(value, name);
+  } else if (name == "sweep-beta") {
+    params.sweepBetas = parseFractions(value, name);
+  } else if (name == "save-graph") {
+    if (value.empty()) {
+      throw std::runtime_error("--save-graph needs a file name!");
+    }
+    params.saveGraph = value;
+  } else if (name == "profile") {
+    if (value.empty()) {
+      throw std::runtime_error("--profile needs a file name!");
+    }
+    params.profileFile = value;
+    params.options.profile = true;
+  } else if (name == "trace") {
+    if (value.empty()) {
+      throw std::runtime_error("--trace needs a file name!");
+    }
+    params.traceFile = value;
+  } else if (name == "evaluate") {
+    if (value.empty()) {
+      throw std::runtime_error("--evaluate needs a file name!");
+    }
+    params.evaluationFile = value;
+  } else if (name == "ego-clusters") {
+    std::tie(params.ego.minClusters, params.ego.maxClusters) =
+        parseRange<size_t>(value, name);
+    if (params.ego.minClusters == 0) {
+      throw std::runtime_error("--ego-clusters needs at least 1 cluster!");
+    }
+  } else if (name == "ego-cluster-size") {
+    // MEAN or MEAN:STDDEV
+    const size_t colon = value.find(':');
+    params.ego.clusterMeanSize = std::stoi(value.substr(0, colon));
+    if (params.ego.clusterMeanSize < 1) {
+      throw std::runtime_error("--ego-cluster-size needs a mean >= 1!");
+    }
+    if (colon != std::string::npos) {
+      params.ego.clusterStdDev = std::stoi(value.substr(colon + 1));
+      if (params.ego.clusterStdDev < 0) {
+        throw std::runtime_error("--ego-cluster-size needs a stddev >= 0!");
+      }
+    }
+  } else if (name == "ego-overlap") {
+    std::tie(params.ego.minOverlap, params.ego.maxOverlap) =
+        parseRange<int>(value, name);
+  } else if (name == "ego-inter-edges") {
+    std::tie(params.ego.minInterEdges, params.ego.maxInterEdges) =
+        parseRange<int>(value, name);
+  } else if (name == "ego-pair-probability") {
+    params.ego.pairProbability = std::stod(value);
+    if (params.ego.pairProbability < 0 || params.ego.pairProbability > 1) {
+      throw std::runtime_error(
+          "--ego-pair-probability must be between 0 and 1!");
+    }
+  } else {
+    throw std::runtime_error("Unknown option '" + arg + "'!");
+  }
+}
+
+} // namespace
 
 AppParams parseArgs(int argc, char *argv[]) {
   AppParams params;
 
+  // flags may appear anywhere, the remaining arguments are positional
+  std::vector<char *> positional;
+  for (int i = 0; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (i > 0 && arg.rfind("--", 0) == 0) {
+      parseFlag(arg, params);
+    } else {
+      positional.push_back(argv[i]);
+    }
+  }
+  argc = static_cast<int>(positional.size());
+  argv = positional.data();
+
+  // The bitsliced engine always resamples the neighbors
+  if (params.options.majoritySampling == MajoritySampling::Counts &&
+      params.options.engine != SignatureEngine::Scalar) {
+    throw std::runtime_error("--majority=counts needs --engine=scalar!");
+  }
+
+  // Scores the clusters of an earlier run instead of clustering
+  if (argc >= 2 && static_cast<std::string>(argv[1]) == "eval") {
+    if (argc != 3) {
+      throw std::runtime_error("Usage: ./OverCoDe eval OutputFile "
+                               "[--evaluate=file] [--threads=N]");
+    }
+    params.evaluationMode = true;
+    params.filename = argv[2];
+    return params;
+  }
+
   if (argc < 7) {
     throw std::runtime_error(
-        "Not enough Arguments! Usage: ./OverCoDe <true|false> alpha beta "
-        "OutputFile Graphs Runs overlapSize [overlapSize ...]");
+        "Not enough Arguments! Usage: ./OverCoDe <true|false|file> alpha "
+        "beta OutputFile Graphs Runs "
+        "<overlapSize [overlapSize ...] | EdgeListFile [n]> "
+        "[--engine=scalar|bitsliced] [--seed=N] "
+        "[--push=auto|exact|multinomial] [--majority=neighbors|counts] "
+        "[--termination=full|decided|stable] [--flip-epsilon=x] "
+        "[--patience=N] [--batch=N] [--stable-batches=N] "
+        "[--time-budget=seconds] [--lsh-recall=x] "
+        "[--parallelism=auto|runs|nodes] [--threads=N] "
+        "[--ego-clusters=min:max] [--ego-cluster-size=mean[:stddev]] "
+        "[--ego-overlap=min:max] [--ego-inter-edges=min:max] "
+        "[--ego-pair-probability=x] [--save-graph=file] "
+        "[--sweep-alpha=x,y,...] [--sweep-beta=x,y,...] "
+        "[--profile=file[.csv]] [--trace=file] [--evaluate=file]\n"
+        "       ./OverCoDe eval OutputFile [--evaluate=file] [--threads=N]");
   }
 
   if (std::stod(argv[2]) > 1 || std::stod(argv[2]) <= 0 ||
@@ -22,6 +252,16 @@ AppParams parseArgs(int argc, char *argv[]) {
   params.alpha = std::stod(argv[2]);
   params.beta = std::stod(argv[3]);
 
+  // A sweep over one parameter keeps the other one fixed
+  if (!params.sweepAlphas.empty() || !params.sweepBetas.empty()) {
+    if (params.sweepAlphas.empty()) {
+      params.sweepAlphas.push_back(params.alpha);
+    }
+    if (params.sweepBetas.empty()) {
+      params.sweepBetas.push_back(params.beta);
+    }
+  }
+
   if (std::stoi(argv[5]) < 1 || std::stoi(argv[6]) < 1) {
     throw std::runtime_error("Graphs and Runs must be >= 1!");
   }
@@ -37,7 +277,7 @@ AppParams parseArgs(int argc, char *argv[]) {
     }
 
     params.isEgoGraph = true;
-    params.n = 125;
+    params.n = params.ego.clusterMeanSize;
 
     double logn = log2(params.n);
 
@@ -68,6 +308,30 @@ AppParams parseArgs(int argc, char *argv[]) {
     int c = 2; // two or three
     params.k = static_cast<int>(c * sqrt(params.n) * logn);
     params.h = static_cast<int>(c * sqrt(params.n));
+
+  } else if (static_cast<std::string>(argv[1]) == "file") {
+    if (argc != 8 && argc != 9) {
+      throw std::runtime_error(
+          "Usage: ./main file Alpha Beta OutputFile Graphs Runs EdgeListFile "
+          "[n]");
+    }
+
+    params.graphFile = argv[7];
+
+    // n: typical cluster size, which the parameters are derived from as for
+    // the ego graphs
+    params.n = argc == 9 ? std::stoi(argv[8]) : 125;
+    if (params.n < 2) {
+      throw std::runtime_error("n must be >= 2!");
+    }
+
+    double logn = log2(params.n);
+
+    params.T = static_cast<int>(50 * logn);
+    params.l = static_cast<int>(250 * logn);
+    int c = 2; // two or three
+    params.k = static_cast<int>(c * sqrt(params.n) * logn);
+    params.h = static_cast<int>(c * sqrt(params.n));
   }
   std::cout << "Calculated parameters:" << std::endl;
   std::cout << "  n (nodes): " << params.n << std::endl;
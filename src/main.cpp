@@ -1,58 +1,101 @@
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <ostream>
+#include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "ArgsParser.h"
 #include "ClusteredGraph.h"
+#include "EdgeListGraph.h"
+#include "Evaluation.h"
 #include "Graph.h"
+#include "GraphSnapshot.h"
 #include "OverCoDe.h"
+#include "Pipeline.h"
+#include "RunProfile.h"
 #include "SyntheticEgoGraph.h"
+#include "ThreadPool.h"
+#include "Trace.h"
 
-/**
- * @brief Checks if an int vector contains a number.
- * A wrapper around std::any_of
- *
- * @param[in] g The vector to check
- * @param[in] n The number to check for
- * @return True if it is contained, false if not
- */
-bool contains(const std::vector<int> &g, const size_t n) {
-  return std::any_of(g.begin(), g.end(),
-                     [&n](const size_t i) { return i == n; });
-}
+namespace {
+
+// The generator of the next graph gets 1 / GENERATOR_THREAD_SHARE of the
+// threads while it overlaps the clustering
+constexpr size_t GENERATOR_THREAD_SHARE = 8;
 
-std::vector<std::vector<int>> readGraphFromFile(const std::string &filename) {
-  std::vector<std::vector<int>> adjList;
-  std::ifstream a;
-  a.open(filename);
-  std::string read;
-  while (a) {
-    a >> read;
-    size_t node1 = std::stoull(read);
-    a >> read;
-    size_t node2 = stoull(read);
-    if (node1 >= adjList.size()) {
-      adjList.resize(node1 + 1);
+// Writes the clusters found in run j on graph i in the output file format
+// and returns their number. representative(c) is the signature of cluster c.
+template <class Representative>
+size_t writeClusters(std::ostream &f, const int i, const int j,
+                     const ClusterMembership &clusters,
+                     Representative representative) {
+  f << i << " " << j << "\n";
+  for (size_t id = 0; id < clusters.clusters(); id++) {
+    f << "Cluster " << id + 1 << ": ";
+    for (int num : representative(id)) {
+      f << num << " ";
     }
-    if (node2 >= adjList.size()) {
-      adjList.resize(node2 + 1);
+    f << "\n";
+    for (NodeId num : clusters.nodesOf(id)) {
+      f << num << " ";
     }
+    f << "\n\n";
+  }
+  f << "\n\n";
+  return clusters.clusters();
+}
+
+// A generated graph on its way from the generator to the clustering
+struct ReadyGraph {
+  GeneratedGraph graph;
+  double seconds = 0;   // spent generating it
+  std::string snapshot; // file it was saved to, if any
+};
+
+// Output file of one point of a sweep
+std::string sweepFile(const std::string &filename, const double alpha,
+                      const double beta) {
+  std::ostringstream name;
+  name << filename << "_alpha" << alpha << "_beta" << beta;
+  return name.str();
+}
 
-    if (contains(adjList[node1], node2) || contains(adjList[node2], node1)) {
-      continue;
+// ./OverCoDe eval: scores the runs of a cluster file against its truth file
+void evaluateFiles(const AppParams &params) {
+  ThreadPool pool(params.options.threads);
+  const std::vector<ClusteredRun> found = readClusterFile(params.filename);
+  const std::vector<ClusteredRun> truth =
+      readClusterFile(params.filename + "_truth");
+  const std::vector<Evaluation> evaluations = evaluateRuns(found, truth, pool);
+
+  std::unique_ptr<EvaluationWriter> rows;
+  if (!params.evaluationFile.empty()) {
+    rows = std::make_unique<EvaluationWriter>(params.evaluationFile);
+  }
+  const double unknown = std::numeric_limits<double>::quiet_NaN();
+  EvaluationSummary summary;
+  for (size_t r = 0; r < found.size(); r++) {
+    summary.add(evaluations[r]);
+    if (rows) {
+      rows->write(evaluations[r], found[r].graph, found[r].run, unknown,
+                  unknown);
     }
-    adjList[node1].push_back(static_cast<int>(node2));
-    adjList[node2].push_back(static_cast<int>(node1));
   }
-  return adjList;
+  summary.write(std::cout);
 }
 
+} // namespace
+
 int main(int argc, char *argv[]) {
-  auto startTime = time(nullptr);
+  const auto startTime = std::chrono::steady_clock::now();
 
   // beta = 0.95; // similarity threshold
   // beta = 0.85; // For ego graph
@@ -66,9 +109,22 @@ int main(int argc, char *argv[]) {
     return -1;
   }
 
+  if (params.evaluationMode) {
+    try {
+      evaluateFiles(params);
+    } catch (const std::exception &e) {
+      std::cerr << "Error evaluating '" << params.filename << "': " << e.what()
+                << std::endl;
+      return -1;
+    }
+    return 0;
+  }
+
   std::cout << "Running with " << params.graphs << " graphs and " << params.runs
             << " runs." << std::endl;
-  if (!params.isEgoGraph) {
+  if (!params.graphFile.empty()) {
+    std::cout << "Graph file '" << params.graphFile << "'." << std::endl;
+  } else if (!params.isEgoGraph) {
     bool first = true;
     std::cout << "Cluster Graph, with overlaps: " << std::endl;
     for (unsigned long long overlap : params.overlaps) {
@@ -94,60 +150,215 @@ int main(int argc, char *argv[]) {
   a.open(params.filename + "_truth");
   a.close();
 
+  for (const double alpha : params.sweepAlphas) {
+    for (const double beta : params.sweepBetas) {
+      a.open(sweepFile(params.filename, alpha, beta));
+      a.close();
+    }
+  }
+
+  std::unique_ptr<ProfileWriter> profiles;
+  if (!params.profileFile.empty()) {
+    profiles = std::make_unique<ProfileWriter>(params.profileFile);
+  }
+
+  // Scores against the ground truth, one summary per point of a sweep
+  std::unique_ptr<EvaluationWriter> evaluations;
+  std::vector<EvaluationSummary> summaries;
+  std::vector<std::pair<double, double>> summaryPoints; // alpha, beta
+  if (!params.evaluationFile.empty()) {
+    evaluations = std::make_unique<EvaluationWriter>(params.evaluationFile);
+  }
+
   std::cout << "Before graph" << std::endl;
 
+  // The worker threads and their scratch buffers serve all graphs and runs
+  ThreadPool pool(params.options.threads);
+
+  std::unique_ptr<Tracer> tracer;
+  if (!params.traceFile.empty()) {
+    tracer = std::make_unique<Tracer>();
+    params.options.tracer = tracer.get();
+    pool.setTracer(tracer.get());
+  }
+
+  // The generator stays one graph ahead of the clustering. The first graph
+  // is generated on the main pool while main waits for it; the later ones
+  // overlap the clustering and get a pool of their own, an eighth of the
+  // threads, so the two together only slightly exceed --threads.
+  std::unique_ptr<ThreadPool> generatorPool;
+  if (params.graphs > 1) {
+    generatorPool = std::make_unique<ThreadPool>(
+        std::max<size_t>(1, pool.size() / GENERATOR_THREAD_SHARE));
+    generatorPool->setTracer(tracer.get());
+  }
+
   std::unique_ptr<Graph> graph;
 
-  if (params.isEgoGraph) {
-    graph = std::unique_ptr<Graph>(new SyntheticEgoGraph());
+  if (!params.graphFile.empty() &&
+      SnapshotGraph::isSnapshot(params.graphFile)) {
+    graph = std::unique_ptr<Graph>(new SnapshotGraph(params.graphFile));
+  } else if (!params.graphFile.empty()) {
+    graph = std::unique_ptr<Graph>(new EdgeListGraph(params.graphFile, &pool));
+  } else if (params.isEgoGraph) {
+    graph = std::unique_ptr<Graph>(new SyntheticEgoGraph(params.ego));
   } else {
-    graph = std::unique_ptr<Graph>(
-        new ClusteredGraph(static_cast<size_t>(params.n), params.overlaps));
+    graph = std::unique_ptr<Graph>(new ClusteredGraph(
+        static_cast<size_t>(params.n), params.overlaps, &pool));
   }
 
+  // Results go to the files on a writer thread, and are scored against the
+  // truth on another one
+  FileWriter output;
+  SerialStage scoring;
+
+  Prefetcher<ReadyGraph> graphs(
+      static_cast<size_t>(params.graphs), 1, [&](const size_t i) {
+        ReadyGraph ready;
+        graph->setThreadPool(i == 0 ? &pool : generatorPool.get());
+        const auto graphStart = std::chrono::steady_clock::now();
+        graph->generateGraph();
+        ready.seconds = secondsSince(graphStart);
+        if (tracer) {
+          tracer->record("graph", graphStart, std::chrono::steady_clock::now(),
+                         "graph", static_cast<std::uint64_t>(i));
+        }
+        if (!params.saveGraph.empty()) {
+          ready.snapshot = params.graphs == 1
+                               ? params.saveGraph
+                               : params.saveGraph + "_" + std::to_string(i);
+          SnapshotGraph::write(*graph, ready.snapshot);
+        }
+        ready.graph = graph->release();
+        return ready;
+      });
+
   for (int i = 0; i < params.graphs; i++) {
-    graph->generateGraph();
+    const ReadyGraph ready = graphs.next();
+    const GeneratedGraph &generated = ready.graph;
 
     std::cout << "Graph created" << std::endl;
+    if (!ready.snapshot.empty()) {
+      std::cout << "Graph saved to '" << ready.snapshot << "'" << std::endl;
+    }
+
+    // Edge lists come without ground truth. The truth holds for every run
+    // on the graph, and is written once under a "graph nodes n" header.
+    if (!generated.clusters.empty()) {
+      std::ostringstream truthText;
+      truthText << i << " nodes " << generated.adjList.size() << "\n";
+      Graph::writeTruth(truthText, generated.clusters);
+      output.append(params.filename + "_truth", truthText.str());
+    }
+
+    std::shared_ptr<const ClusterMembership> truth;
+    const bool evaluating = evaluations && !generated.clusters.empty();
+    if (evaluating) {
+      truth = std::make_shared<const ClusterMembership>(
+          ClusterMembership::fromClusters(generated.clusters,
+                                          generated.adjList.size()));
+    } else if (evaluations && i == 0) {
+      std::cout << "The graph has no ground truth to evaluate against."
+                << std::endl;
+    }
+
+    // the graph is only viewed, so one instance serves all runs on it
+    OverCoDe ocd(generated.adjList, params.T, params.k, params.rho, params.h,
+                 static_cast<size_t>(params.l), params.beta, params.alpha,
+                 params.options, &pool);
 
     for (int j = 0; j < params.runs; j++) {
       std::cout << "[" << i << "]" << "[" << j << "]" << std::endl;
-      OverCoDe ocd(graph->getAdjList(), params.T, params.k, params.rho,
-                   params.h, static_cast<size_t>(params.l), params.beta,
-                   params.alpha);
-      ocd.runOverCoDe();
-
-      std::ofstream f;
-      f.open(params.filename, std::ofstream::app);
-      int c = 0;
-
-      f << i << " " << j << std::endl;
-      a.open(params.filename + "_truth", std::ofstream::app);
-      a << i << " " << j << std::endl;
-      a.close();
-      graph->appendTruthToFile(params.filename + "_truth");
 
-      auto clusters = ocd.getClusters();
-      for (const auto &cluster : clusters) {
-        f << "Cluster " << ++c << ": ";
-        for (int num : cluster.first) {
-          f << num << " ";
+      // One set of runs serves every point of a sweep
+      if (!params.sweepAlphas.empty()) {
+        std::vector<OverCoDe::SweepResult> points =
+            ocd.sweep(params.sweepAlphas, params.sweepBetas);
+        TraceScope scope(tracer.get(), "output");
+        for (const OverCoDe::SweepResult &point : points) {
+          std::ostringstream text;
+          const size_t c = writeClusters(
+              text, i, j, point.clusters,
+              [&point](const size_t id) -> const std::vector<int> & {
+                return point.representatives[id];
+              });
+          output.append(sweepFile(params.filename, point.alpha, point.beta),
+                        text.str());
+          std::cout << "alpha " << point.alpha << ", beta " << point.beta
+                    << ": " << c << " clusters." << std::endl;
         }
-        f << std::endl;
-        for (int num : cluster.second) {
-          f << num << " ";
+        if (evaluating) {
+          scoring.add([&, truth, i, j,
+                       found = std::make_shared<
+                           const std::vector<OverCoDe::SweepResult>>(
+                           std::move(points))]() {
+            summaries.resize(found->size());
+            summaryPoints.resize(found->size());
+            for (size_t p = 0; p < found->size(); p++) {
+              const OverCoDe::SweepResult &point = (*found)[p];
+              const Evaluation e = evaluate(point.clusters, *truth);
+              evaluations->write(e, i, j, point.alpha, point.beta);
+              summaries[p].add(e);
+              summaryPoints[p] = {point.alpha, point.beta};
+            }
+          });
         }
-        f << std::endl;
-        f << std::endl;
+      } else {
+        ocd.runOverCoDe();
+        TraceScope scope(tracer.get(), "output");
+        std::ostringstream text;
+        const size_t c = writeClusters(text, i, j, ocd.getClusters(),
+                                       [&ocd](const size_t id) {
+                                         return ocd.representative(id);
+                                       });
+        output.append(params.filename, text.str());
+        std::cout << c << " clusters." << std::endl;
+        if (evaluating) {
+          // The instance's clusters are replaced by the next run
+          scoring.add([&, truth, i, j, found = ocd.getClusters()]() {
+            const Evaluation e = evaluate(found, *truth);
+            evaluations->write(e, i, j, params.alpha, params.beta);
+            summaries.resize(1);
+            summaryPoints.assign(1, {params.alpha, params.beta});
+            summaries[0].add(e);
+          });
+        }
+      }
+
+      // The graph is generated once for all runs, and counted in the first
+      if (profiles) {
+        RunProfile profile = ocd.profile();
+        profile.caller.add(Phase::Graph, j == 0 ? ready.seconds : 0.0);
+        profiles->write(profile, i, j);
       }
-      f << std::endl << std::endl;
-      f.close();
-      std::cout << c << " clusters." << std::endl;
     }
-    graph->deleteGraph();
   }
 
-  auto elapsedTime = time(nullptr) - startTime;
+  try {
+    output.finish();
+  } catch (const std::exception &e) {
+    std::cerr << "Error writing results: " << e.what() << std::endl;
+    return -1;
+  }
+  try {
+    scoring.finish();
+  } catch (const std::exception &e) {
+    std::cerr << "Error evaluating results: " << e.what() << std::endl;
+    return -1;
+  }
+
+  for (size_t p = 0; p < summaries.size(); p++) {
+    std::cout << "\nEvaluation at alpha " << summaryPoints[p].first
+              << ", beta " << summaryPoints[p].second << ":" << std::endl;
+    summaries[p].write(std::cout);
+  }
+
+  if (tracer) {
+    tracer->write(params.traceFile);
+    std::cout << "Trace written to '" << params.traceFile << "'" << std::endl;
+  }
+
+  const auto elapsedTime = static_cast<long long>(secondsSince(startTime));
 
   std::cout << ((elapsedTime / 60) / 60) << "h " << (elapsedTime / 60) % 60
             << "min " << elapsedTime % 60 << "s" << std::endl;
@@ -57,3 +57,203 @@ TEST(ArgsParserTest, EgoGraphParams) {
   EXPECT_EQ(params.n, 125);
   EXPECT_GT(params.T, 0);
 }
+
+TEST(ArgsParserTest, EngineFlag) {
+  // Flags may appear between the positional arguments
+  std::vector<std::string> args = {
+      "./OverCoDe", "true", "0.92", "0.95", "--engine=scalar",
+      "result.txt", "1",    "1"};
+
+  std::vector<char *> argv = makeArgv(args);
+  int argc = static_cast<int>(argv.size());
+
+  AppParams params = parseArgs(argc, argv.data());
+
+  EXPECT_EQ(params.options.engine, SignatureEngine::Scalar);
+  EXPECT_EQ(params.filename, "result.txt");
+
+  args[4] = "--engine=gpu";
+  argv = makeArgv(args);
+  EXPECT_THROW(parseArgs(argc, argv.data()), std::runtime_error);
+}
+
+TEST(ArgsParserTest, MajorityCountsNeedsScalarEngine) {
+  std::vector<std::string> args = {"./OverCoDe", "true", "0.92", "0.95",
+                                   "result.txt", "1",    "1",
+                                   "--majority=counts"};
+
+  std::vector<char *> argv = makeArgv(args);
+  EXPECT_THROW(parseArgs(static_cast<int>(argv.size()), argv.data()),
+               std::runtime_error);
+
+  // The engine may follow the majority flag
+  args.push_back("--engine=scalar");
+  argv = makeArgv(args);
+  AppParams params = parseArgs(static_cast<int>(argv.size()), argv.data());
+  EXPECT_EQ(params.options.majoritySampling, MajoritySampling::Counts);
+}
+
+TEST(ArgsParserTest, SeedFlag) {
+  std::vector<std::string> args = {"./OverCoDe", "true", "0.92", "0.95",
+                                   "result.txt", "1",    "1",    "--seed=42"};
+
+  std::vector<char *> argv = makeArgv(args);
+  int argc = static_cast<int>(argv.size());
+
+  AppParams params = parseArgs(argc, argv.data());
+
+  ASSERT_TRUE(params.options.seed.has_value());
+  EXPECT_EQ(*params.options.seed, 42U);
+}
+
+TEST(ArgsParserTest, AnytimeFlags) {
+  std::vector<std::string> args = {"./OverCoDe",         "true",
+                                   "0.92",               "0.95",
+                                   "result.txt",         "1",
+                                   "1",                  "--batch=128",
+                                   "--stable-batches=3", "--time-budget=2.5"};
+
+  std::vector<char *> argv = makeArgv(args);
+  AppParams params = parseArgs(static_cast<int>(argv.size()), argv.data());
+
+  EXPECT_EQ(params.options.batchRuns, 128U);
+  EXPECT_EQ(params.options.stableBatches, 3U);
+  EXPECT_DOUBLE_EQ(params.options.timeBudget, 2.5);
+
+  for (const std::string bad :
+       {"--stable-batches=0", "--stable-batches=-1", "--time-budget=-1"}) {
+    std::vector<std::string> badArgs = args;
+    badArgs.push_back(bad);
+    argv = makeArgv(badArgs);
+    EXPECT_THROW(parseArgs(static_cast<int>(argv.size()), argv.data()),
+                 std::runtime_error)
+        << bad;
+  }
+}
+
+TEST(ArgsParserTest, ParallelismFlags) {
+  std::vector<std::string> args = {"./OverCoDe",          "true",
+                                   "0.92",                "0.95",
+                                   "--parallelism=nodes", "result.txt",
+                                   "1",                   "1",
+                                   "--threads=3"};
+
+  std::vector<char *> argv = makeArgv(args);
+  int argc = static_cast<int>(argv.size());
+
+  AppParams params = parseArgs(argc, argv.data());
+
+  EXPECT_EQ(params.options.parallelism, Parallelism::Nodes);
+  EXPECT_EQ(params.options.threads, 3U);
+}
+
+TEST(ArgsParserTest, EgoGraphShapeFlags) {
+  std::vector<std::string> args = {
+      "./OverCoDe", "true", "0.92", "0.95", "result.txt", "1", "1",
+      "--ego-clusters=1000:2000", "--ego-cluster-size=300:40",
+      "--ego-overlap=1:3", "--ego-pair-probability=0.002"};
+
+  std::vector<char *> argv = makeArgv(args);
+  AppParams params = parseArgs(static_cast<int>(argv.size()), argv.data());
+
+  EXPECT_EQ(params.ego.minClusters, 1000U);
+  EXPECT_EQ(params.ego.maxClusters, 2000U);
+  EXPECT_EQ(params.ego.clusterMeanSize, 300);
+  EXPECT_EQ(params.ego.clusterStdDev, 40);
+  EXPECT_EQ(params.ego.maxOverlap, 3);
+  EXPECT_DOUBLE_EQ(params.ego.pairProbability, 0.002);
+  EXPECT_EQ(params.n, 300); // the derived parameters follow the cluster size
+
+  args[7] = "--ego-clusters=5:2";
+  argv = makeArgv(args);
+  EXPECT_THROW(parseArgs(static_cast<int>(argv.size()), argv.data()),
+               std::runtime_error);
+
+  // A mean alone keeps the default stddev
+  args[7] = "--ego-clusters=4:6";
+  args[8] = "--ego-cluster-size=200";
+  argv = makeArgv(args);
+  params = parseArgs(static_cast<int>(argv.size()), argv.data());
+  EXPECT_EQ(params.ego.clusterMeanSize, 200);
+  EXPECT_EQ(params.ego.clusterStdDev, EgoGraphParams{}.clusterStdDev);
+
+  args[8] = "--ego-cluster-size=200:-1";
+  argv = makeArgv(args);
+  EXPECT_THROW(parseArgs(static_cast<int>(argv.size()), argv.data()),
+               std::runtime_error);
+}
+
+TEST(ArgsParserTest, EdgeListSource) {
+  std::vector<std::string> args = {"./OverCoDe", "file", "0.92", "0.85",
+                                   "result.txt", "1",    "2",    "graph.txt",
+                                   "200"};
+
+  std::vector<char *> argv = makeArgv(args);
+  AppParams params = parseArgs(static_cast<int>(argv.size()), argv.data());
+
+  EXPECT_EQ(params.graphFile, "graph.txt");
+  EXPECT_FALSE(params.isEgoGraph);
+  EXPECT_EQ(params.n, 200);
+  EXPECT_GT(params.l, params.T);
+
+  args.resize(8); // n is optional
+  argv = makeArgv(args);
+  EXPECT_EQ(parseArgs(static_cast<int>(argv.size()), argv.data()).n, 125);
+}
+
+TEST(ArgsParserTest, SweepFlags) {
+  std::vector<std::string> args = {"./OverCoDe",    "true", "0.92", "0.85",
+                                   "result.txt",    "1",    "1",
+                                   "--sweep-alpha=0.9,0.95"};
+
+  std::vector<char *> argv = makeArgv(args);
+  AppParams params = parseArgs(static_cast<int>(argv.size()), argv.data());
+  EXPECT_EQ(params.sweepAlphas, (std::vector<double>{0.9, 0.95}));
+  EXPECT_EQ(params.sweepBetas, (std::vector<double>{0.85}));
+
+  args[7] = "--sweep-beta=0.5,1.5";
+  argv = makeArgv(args);
+  EXPECT_THROW(parseArgs(static_cast<int>(argv.size()), argv.data()),
+               std::runtime_error);
+}
+
+TEST(ArgsParserTest, ProfileFlag) {
+  std::vector<std::string> args = {"./OverCoDe", "true", "0.92", "0.85",
+                                   "result.txt", "1",    "1"};
+  std::vector<char *> argv = makeArgv(args);
+  AppParams params = parseArgs(static_cast<int>(argv.size()), argv.data());
+  EXPECT_FALSE(params.options.profile);
+
+  args.push_back("--profile=phases.csv");
+  argv = makeArgv(args);
+  params = parseArgs(static_cast<int>(argv.size()), argv.data());
+  EXPECT_TRUE(params.options.profile);
+  EXPECT_EQ(params.profileFile, "phases.csv");
+
+  args.back() = "--profile=";
+  argv = makeArgv(args);
+  EXPECT_THROW(parseArgs(static_cast<int>(argv.size()), argv.data()),
+               std::runtime_error);
+
+  args.back() = "--trace=timeline.json";
+  argv = makeArgv(args);
+  params = parseArgs(static_cast<int>(argv.size()), argv.data());
+  EXPECT_EQ(params.traceFile, "timeline.json");
+  EXPECT_EQ(params.options.tracer, nullptr); // created by main
+}
+
+TEST(ArgsParserTest, EvaluationMode) {
+  std::vector<std::string> args = {"./OverCoDe", "eval", "result.txt",
+                                   "--evaluate=scores.csv", "--threads=2"};
+  std::vector<char *> argv = makeArgv(args);
+  AppParams params = parseArgs(static_cast<int>(argv.size()), argv.data());
+  EXPECT_TRUE(params.evaluationMode);
+  EXPECT_EQ(params.filename, "result.txt");
+  EXPECT_EQ(params.evaluationFile, "scores.csv");
+  EXPECT_EQ(params.options.threads, 2U);
+
+  args = {"./OverCoDe", "eval"};
+  argv = makeArgv(args);
+  EXPECT_THROW(parseArgs(static_cast<int>(argv.size()), argv.data()),
+               std::runtime_error);
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "BitslicedProcess.h"
+
+// Complete graph on n nodes
+static CSRGraph completeGraph(const NodeId n) {
+  EdgeList edges;
+  for (NodeId u = 0; u < n; u++) {
+    for (NodeId v = u + 1; v < n; v++) {
+      edges.emplace_back(u, v);
+    }
+  }
+  return CSRGraph::fromEdges(n, edges);
+}
+
+TEST(BitslicedProcessTest, CliqueReachesConsensusInEveryLane) {
+  const CSRGraph graph = completeGraph(20);
+
+  for (const PushSampling sampling :
+       {PushSampling::Exact, PushSampling::Multinomial}) {
+    OverCoDeOptions options;
+    options.pushSampling = sampling;
+    BitslicedProcess process(options);
+    std::vector<std::uint64_t> red;
+    std::vector<std::uint64_t> blue;
+
+    SequentialStream stream(1);
+
+    process.run(graph, 60, 40, 3, 4, 0.6, stream, 0, 64, red, blue);
+
+    ASSERT_EQ(red.size(), 20);
+    // The majority dynamics on a clique settle quickly, so every node is
+    // decided and all nodes agree within each run.
+    for (size_t u = 0; u < graph.size(); u++) {
+      EXPECT_EQ(red[u] | blue[u], ~std::uint64_t{0});
+      EXPECT_EQ(red[u] & blue[u], 0);
+      EXPECT_EQ(red[u], red[0]);
+    }
+  }
+}
+
+TEST(BitslicedProcessTest, UnusedLanesStayClear) {
+  const CSRGraph graph = completeGraph(8);
+  BitslicedProcess process;
+  std::vector<std::uint64_t> red;
+  std::vector<std::uint64_t> blue;
+
+  CounterStream stream(7);
+
+  process.run(graph, 20, 2, 4, 2, 0.6, stream, 0, 5, red, blue);
+
+  for (size_t u = 0; u < graph.size(); u++) {
+    EXPECT_EQ((red[u] | blue[u]) >> 5, 0);
+  }
+}
+
+TEST(BitslicedProcessTest, InvalidLaneCount) {
+  const CSRGraph graph = completeGraph(4);
+  BitslicedProcess process;
+  std::vector<std::uint64_t> red;
+  std::vector<std::uint64_t> blue;
+  SequentialStream stream(1);
+
+  EXPECT_THROW(process.run(graph, 10, 2, 3, 2, 0.6, stream, 0, 0, red, blue),
+               std::invalid_argument);
+  EXPECT_THROW(process.run(graph, 10, 2, 3, 2, 0.6, stream, 0, 65, red, blue),
+               std::invalid_argument);
+}
+
+TEST(BitslicedProcessTest, CounterStreamIsReproducible) {
+  const CSRGraph graph = completeGraph(12);
+  BitslicedProcess first;
+  BitslicedProcess second;
+  std::vector<std::uint64_t> red1, blue1, red2, blue2;
+  CounterStream stream1(99);
+  CounterStream stream2(99);
+
+  first.run(graph, 30, 3, 3, 3, 0.9, stream1, 64, 64, red1, blue1);
+  second.run(graph, 30, 3, 3, 3, 0.9, stream2, 64, 64, red2, blue2);
+
+  EXPECT_EQ(red1, red2);
+  EXPECT_EQ(blue1, blue2);
+}
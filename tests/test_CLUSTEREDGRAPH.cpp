@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <gtest/gtest.h>
 #include <set>
 #include <stdexcept>
@@ -97,3 +98,42 @@ TEST(ClusteredGraphTest, NodeAndClusterSetup) {
   // C(3,3) = 1 triplet. 1 triplet * 1 node/overlap = 1 node that appears thrice
   EXPECT_EQ(overlap3Count, 1);
 }
+
+// Edge density within and between two disjoint clusters of 400 nodes
+TEST(ClusteredGraphTest, EdgeDensitiesMatchProbabilities) {
+  const size_t n = 400;
+  ThreadPool pool(2);
+  ClusteredGraph graph(n, {0, 0}, &pool);
+  graph.generateGraph();
+  const CSRGraph &adj = graph.getAdjList();
+  ASSERT_EQ(adj.size(), 2 * n);
+
+  const double p = 2.5 * std::pow(std::log2(400.0) / 400.0, 0.25);
+  const double q = p / 150;
+  size_t intra = 0;
+  size_t inter = 0;
+  for (NodeId u = 0; u < adj.size(); u++) {
+    const std::set<NodeId> unique(adj[u].begin(), adj[u].end());
+    EXPECT_EQ(unique.size(), adj.degree(u)) << "duplicate edge at " << u;
+    EXPECT_EQ(unique.count(u), 0U) << "self-loop at " << u;
+    for (const NodeId v : adj[u]) {
+      (u < n) == (v < n) ? intra++ : inter++;
+    }
+  }
+  // Every edge is seen from both ends
+  const double intraPairs = 2.0 * n * (n - 1) / 2;
+  const double interPairs = 1.0 * n * n;
+  EXPECT_NEAR(intra / 2 / intraPairs, p, 0.01);
+  EXPECT_NEAR(inter / 2 / interPairs, q, 0.002);
+}
+
+TEST(ClusteredGraphTest, OverlappingNodesGetNoDuplicateEdges) {
+  ClusteredGraph graph(30, {0, 4, 2});
+  graph.generateGraph();
+  const CSRGraph &adj = graph.getAdjList();
+  for (NodeId u = 0; u < adj.size(); u++) {
+    const std::set<NodeId> unique(adj[u].begin(), adj[u].end());
+    EXPECT_EQ(unique.size(), adj.degree(u));
+    EXPECT_EQ(unique.count(u), 0U);
+  }
+}
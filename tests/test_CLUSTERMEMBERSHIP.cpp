@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "ClusterMembership.h"
+
+TEST(ClusterMembershipTest, BothDirectionsAgree) {
+  // Node 2 is in both clusters, node 3 in none
+  const ClusterMembership membership({{0}, {0}, {0, 1}, {}, {1}}, 2);
+
+  EXPECT_EQ(membership.nodes(), 5U);
+  EXPECT_EQ(membership.clusters(), 2U);
+  EXPECT_EQ(membership.entries(), 5U);
+  EXPECT_TRUE(membership.clustersOf(3).empty());
+  ASSERT_EQ(membership.clustersOf(2).size(), 2U);
+  EXPECT_EQ(membership.clustersOf(2)[1], 1U);
+
+  const std::vector<NodeId> first(membership.nodesOf(0).begin(),
+                                  membership.nodesOf(0).end());
+  const std::vector<NodeId> second(membership.nodesOf(1).begin(),
+                                   membership.nodesOf(1).end());
+  EXPECT_EQ(first, (std::vector<NodeId>{0, 1, 2}));
+  EXPECT_EQ(second, (std::vector<NodeId>{2, 4}));
+}
+
+TEST(ClusterMembershipTest, EqualityAndRange) {
+  const ClusterMembership a({{0}, {1}}, 2);
+  const ClusterMembership b({{0}, {1}}, 2);
+  const ClusterMembership c({{0}, {0}}, 2);
+  EXPECT_TRUE(a == b);
+  EXPECT_TRUE(a != c);
+  EXPECT_EQ(ClusterMembership().nodes(), 0U);
+
+  EXPECT_THROW(ClusterMembership({{2}}, 2), std::out_of_range);
+}
+
+TEST(ClusterMembershipTest, FromClusterLists) {
+  const std::vector<std::vector<unsigned long long>> lists = {{0, 2, 2},
+                                                              {2, 4}};
+  const ClusterMembership membership =
+      ClusterMembership::fromClusters(lists, 5);
+  EXPECT_EQ(membership, ClusterMembership({{0}, {}, {0, 1}, {}, {1}}, 2));
+  EXPECT_THROW(ClusterMembership::fromClusters(lists, 4), std::out_of_range);
+}
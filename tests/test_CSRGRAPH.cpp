@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "CSRGraph.h"
+
+TEST(CSRGraphTest, FromEdgesStoresBothDirections) {
+  // Path 0-1-2 plus an isolated node 3
+  EdgeList edges = {{0, 1}, {1, 2}};
+  CSRGraph graph = CSRGraph::fromEdges(4, edges);
+
+  ASSERT_EQ(graph.size(), 4);
+  EXPECT_EQ(graph.entries(), 4);
+  EXPECT_EQ(graph.degree(0), 1);
+  EXPECT_EQ(graph.degree(1), 2);
+  EXPECT_EQ(graph.degree(2), 1);
+  EXPECT_TRUE(graph[3].empty());
+
+  std::vector<NodeId> row(graph[1].begin(), graph[1].end());
+  std::sort(row.begin(), row.end());
+  EXPECT_EQ(row, (std::vector<NodeId>{0, 2}));
+}
+
+TEST(CSRGraphTest, AdjacencyListConversionKeepsOrder) {
+  std::vector<std::vector<unsigned long long>> adjList = {{2, 1}, {0}, {0}};
+  CSRGraph graph(adjList);
+
+  const CSRView view = graph;
+  ASSERT_EQ(view.size(), 3);
+  EXPECT_EQ(view[0][0], 2);
+  EXPECT_EQ(view[0][1], 1);
+  EXPECT_EQ(view[2][0], 0);
+}
+
+TEST(CSRGraphTest, RejectsOutOfRangeIds) {
+  EdgeList edges = {{0, 5}};
+  EXPECT_THROW(CSRGraph::fromEdges(2, edges), std::out_of_range);
+
+  std::vector<std::vector<unsigned long long>> adjList = {{3}};
+  EXPECT_THROW(CSRGraph graph(adjList), std::out_of_range);
+}
+
+TEST(CSRGraphTest, FromRowsTakesOverArrays) {
+  CSRGraph graph = CSRGraph::fromRows({0, 1, 3, 4}, {1, 0, 2, 1});
+  ASSERT_EQ(graph.size(), 3);
+  EXPECT_EQ(graph.degree(1), 2);
+  EXPECT_EQ(graph[1][1], 2);
+
+  EXPECT_THROW(CSRGraph::fromRows({0, 2}, {0}), std::invalid_argument);
+  EXPECT_THROW(CSRGraph::fromRows({0, 1}, {1}), std::out_of_range);
+}
+
+TEST(CSRGraphTest, AdoptedRowsStayAliveWithCopies) {
+  auto rows = std::make_shared<std::vector<std::uint64_t>>(
+      std::vector<std::uint64_t>{0, 1, 2});
+  const std::vector<NodeId> neighbors = {1, 0};
+  CSRGraph copy;
+  {
+    CSRGraph graph = CSRGraph::adopt(rows, rows->data(), neighbors.data(), 2,
+                                     neighbors.size());
+    EXPECT_EQ(graph.view().offsetData(), rows->data()); // no copy
+    copy = graph;
+  }
+  rows.reset();
+  ASSERT_EQ(copy.size(), 2);
+  EXPECT_EQ(copy.entries(), 2);
+  EXPECT_EQ(copy[0][0], 1);
+
+  copy.clear();
+  EXPECT_TRUE(copy.empty());
+  const std::uint64_t noRows = 0;
+  EXPECT_THROW(CSRGraph::adopt(nullptr, &noRows, neighbors.data(), 0, 0),
+               std::invalid_argument);
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "EdgeListGraph.h"
+#include "ThreadPool.h"
+
+namespace {
+
+std::string writeTempFile(const std::string &name,
+                          const std::string &contents) {
+  const std::string path = ::testing::TempDir() + name;
+  std::ofstream out(path, std::ios::binary);
+  out << contents;
+  return path;
+}
+
+std::vector<NodeId> row(const CSRGraph &graph, const size_t u) {
+  return {graph[u].begin(), graph[u].end()};
+}
+
+} // namespace
+
+TEST(EdgeListGraphTest, RenumbersAndSimplifies) {
+  // Sparse ids 7 < 20 < 1000000000000 become 0, 1, 2
+  // 20 7 repeats 7 20, "0.5" is an extra column, 7 7 a self-loop and the
+  // last line has no newline
+  const std::string path =
+      writeTempFile("edges_simple.txt", "# FromNodeId\tToNodeId\n"
+                                        "% another comment\n"
+                                        "7 20\n"
+                                        "20\t7\n"
+                                        "  20 1000000000000 0.5\n"
+                                        "7 7\n"
+                                        "\n"
+                                        "1000000000000 7\r\n"
+                                        "7 20");
+  ThreadPool pool(3);
+  EdgeListGraph graph(path, &pool);
+  graph.generateGraph();
+
+  const CSRGraph &adj = graph.getAdjList();
+  ASSERT_EQ(adj.size(), 3U);
+  EXPECT_EQ(adj.entries(), 6U);
+  EXPECT_EQ(row(adj, 0), (std::vector<NodeId>{1, 2}));
+  EXPECT_EQ(row(adj, 1), (std::vector<NodeId>{0, 2}));
+  EXPECT_EQ(row(adj, 2), (std::vector<NodeId>{0, 1}));
+  std::remove(path.c_str());
+}
+
+TEST(EdgeListGraphTest, LargeFileMatchesSequentialLoad) {
+  // Several chunks: a ring over every third id, each edge written twice
+  const size_t n = 200000;
+  std::string contents;
+  for (size_t u = 0; u < n; u++) {
+    const size_t v = (u + 1) % n;
+    contents += std::to_string(3 * u) + " " + std::to_string(3 * v) + "\n";
+    contents += std::to_string(3 * v) + " " + std::to_string(3 * u) + "\n";
+  }
+  const std::string path = writeTempFile("edges_ring.txt", contents);
+
+  ThreadPool pool(4);
+  EdgeListGraph parallel(path, &pool);
+  parallel.generateGraph();
+  EdgeListGraph sequential(path);
+  sequential.generateGraph();
+
+  const CSRGraph &adj = parallel.getAdjList();
+  ASSERT_EQ(adj.size(), n);
+  EXPECT_EQ(adj.entries(), 2 * n);
+  EXPECT_EQ(row(adj, 0), (std::vector<NodeId>{1, n - 1}));
+  EXPECT_EQ(row(adj, 5), (std::vector<NodeId>{4, 6}));
+  for (size_t u = 0; u < n; u += 997) {
+    EXPECT_EQ(row(adj, u), row(sequential.getAdjList(), u));
+  }
+  std::remove(path.c_str());
+}
+
+TEST(EdgeListGraphTest, RejectsMalformedInput) {
+  const std::string path = writeTempFile("edges_bad.txt", "1 2\n3 x\n");
+  EdgeListGraph graph(path);
+  EXPECT_THROW(graph.generateGraph(), std::runtime_error);
+  std::remove(path.c_str());
+
+  EdgeListGraph missing(::testing::TempDir() + "no_such_edge_list.txt");
+  EXPECT_THROW(missing.generateGraph(), std::runtime_error);
+}
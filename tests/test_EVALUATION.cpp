@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Evaluation.h"
+
+// Least total cost over all assignments of the smaller side
+static double bruteForceCost(const std::vector<std::vector<double>> &cost) {
+  const size_t rows = cost.size();
+  const size_t cols = cost[0].size();
+  std::vector<size_t> perm(std::max(rows, cols));
+  std::iota(perm.begin(), perm.end(), 0);
+  double best = 1e300;
+  do {
+    double total = 0;
+    for (size_t i = 0; i < rows; i++) {
+      if (perm[i] < cols) {
+        total += cost[i][perm[i]];
+      }
+    }
+    best = std::min(best, total);
+  } while (std::next_permutation(perm.begin(), perm.end()));
+  return best;
+}
+
+TEST(EvaluationTest, AssignmentMatchesBruteForce) {
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<double> value(-1.0, 1.0);
+  for (const auto &shape : {std::pair<size_t, size_t>{4, 4}, {3, 6}, {6, 3}}) {
+    for (int trial = 0; trial < 20; trial++) {
+      std::vector<std::vector<double>> cost(shape.first,
+                                            std::vector<double>(shape.second));
+      for (auto &row : cost) {
+        for (double &c : row) {
+          c = value(rng);
+        }
+      }
+      const std::vector<size_t> assignment = minimumCostAssignment(cost);
+      double total = 0;
+      std::vector<bool> used(shape.second, false);
+      size_t assigned = 0;
+      for (size_t i = 0; i < shape.first; i++) {
+        if (assignment[i] == UNMATCHED) {
+          continue;
+        }
+        ASSERT_FALSE(used[assignment[i]]);
+        used[assignment[i]] = true;
+        total += cost[i][assignment[i]];
+        assigned++;
+      }
+      EXPECT_EQ(assigned, std::min(shape.first, shape.second));
+      EXPECT_NEAR(total, bruteForceCost(cost), 1e-9);
+    }
+  }
+}
+
+TEST(EvaluationTest, IdenticalClusteringsScorePerfectly) {
+  const ClusterMembership truth({{0}, {0}, {0, 1}, {1}, {1}, {}}, 2);
+  const Evaluation e = evaluate(truth, truth);
+  EXPECT_TRUE(e.clusterCountMatches());
+  EXPECT_DOUBLE_EQ(e.meanJaccard, 1.0);
+  EXPECT_DOUBLE_EQ(e.precision, 1.0);
+  EXPECT_DOUBLE_EQ(e.recall, 1.0);
+  EXPECT_DOUBLE_EQ(e.f1, 1.0);
+  EXPECT_NEAR(e.onmi, 1.0, 1e-12);
+  EXPECT_EQ(e.extraNodes, 0U);
+  EXPECT_EQ(e.missingNodes, 0U);
+  EXPECT_EQ(e.nodesIn, (std::vector<std::uint64_t>{1, 4, 1}));
+  EXPECT_EQ(e.nodesIn, e.truthNodesIn);
+  ASSERT_EQ(e.nodeJaccard.size(), 3U);
+  EXPECT_EQ(e.nodeJaccard[0].count, 0U); // node 5 is in no cluster
+  EXPECT_DOUBLE_EQ(e.nodeJaccard[2].mean(), 1.0);
+}
+
+TEST(EvaluationTest, CountsExtraAndMissingNodes) {
+  // Truth {0..3}, {4..7}; found {0, 1, 2}, {3..7} and the stray {8}
+  const std::vector<std::vector<NodeId>> truthLists = {{0, 1, 2, 3},
+                                                       {4, 5, 6, 7}};
+  const std::vector<std::vector<NodeId>> foundLists = {
+      {0, 1, 2}, {3, 4, 5, 6, 7}, {8}};
+  const Evaluation e =
+      evaluate(ClusterMembership::fromClusters(foundLists, 9),
+               ClusterMembership::fromClusters(truthLists, 8));
+
+  EXPECT_FALSE(e.clusterCountMatches());
+  EXPECT_EQ(e.match, (std::vector<size_t>{0, 1, UNMATCHED}));
+  EXPECT_DOUBLE_EQ(e.meanJaccard, (3.0 / 4 + 4.0 / 5) / 2);
+  EXPECT_EQ(e.extraNodes, 2U); // node 3 and node 8
+  EXPECT_EQ(e.missingNodes, 1U);
+  EXPECT_DOUBLE_EQ(e.precision, 7.0 / 9);
+  EXPECT_DOUBLE_EQ(e.recall, 7.0 / 8);
+  EXPECT_DOUBLE_EQ(e.f1, 2 * (7.0 / 9) * (7.0 / 8) / (7.0 / 9 + 7.0 / 8));
+  EXPECT_EQ(e.truthNodesIn, (std::vector<std::uint64_t>{1, 8}));
+  EXPECT_DOUBLE_EQ(e.nodeJaccard[1].mean(), 7.0 / 8);
+  EXPECT_DOUBLE_EQ(e.nodeJaccard[0].mean(), 0.0);
+
+  const Evaluation reverse =
+      evaluate(ClusterMembership::fromClusters(truthLists, 8),
+               ClusterMembership::fromClusters(foundLists, 9));
+  EXPECT_GT(e.onmi, 0.0);
+  EXPECT_LT(e.onmi, 1.0);
+  EXPECT_NEAR(e.onmi, reverse.onmi, 1e-12);
+}
+
+TEST(EvaluationTest, ReadsAndEvaluatesOutputFiles) {
+  const std::string clusters = ::testing::TempDir() + "eval_clusters";
+  const std::string truth = clusters + "_truth";
+  {
+    std::ofstream out(clusters);
+    out << "0 0\nCluster 1: 1 0 1 \n0 1 2 \n\nCluster 2: 0 1 1 \n2 3 \n\n\n\n"
+        << "0 1\nCluster 1: 1 1 1 \n0 1 2 3 \n\n\n\n";
+    std::ofstream truthOut(truth);
+    truthOut << "0 0\nCluster 1: \n0 1 2 \nCluster 2: \n2 3 \n"
+             << "0 1\nCluster 1: \n0 1 2 \nCluster 2: \n2 3 \n";
+  }
+  const std::vector<ClusteredRun> found = readClusterFile(clusters);
+  ASSERT_EQ(found.size(), 2U);
+  EXPECT_EQ(found[1].run, 1);
+  EXPECT_EQ(found[0].clusters[1], (std::vector<NodeId>{2, 3}));
+
+  ThreadPool pool(2);
+  const std::vector<Evaluation> evaluations =
+      evaluateRuns(found, readClusterFile(truth), pool);
+  ASSERT_EQ(evaluations.size(), 2U);
+  EXPECT_DOUBLE_EQ(evaluations[0].f1, 1.0);
+  EXPECT_EQ(evaluations[1].clusters, 1U);
+
+  EvaluationSummary summary;
+  for (const Evaluation &e : evaluations) {
+    summary.add(e);
+  }
+  std::ostringstream text;
+  summary.write(text);
+  EXPECT_NE(text.str().find("Correctly Clustered Runs: 1\n"),
+            std::string::npos);
+  EXPECT_NE(text.str().find("Nodes in 2 clusters: 1 / 1 = 1\n"),
+            std::string::npos);
+
+  // Truth written once per graph, for every run on it
+  {
+    std::ofstream truthOut(truth);
+    truthOut << "0 nodes 4\nCluster 1: \n0 1 2 \nCluster 2: \n2 3 \n";
+  }
+  const std::vector<ClusteredRun> perGraph = readClusterFile(truth);
+  ASSERT_EQ(perGraph.size(), 1U);
+  EXPECT_EQ(perGraph[0].run, ClusteredRun::EVERY_RUN);
+  EXPECT_EQ(perGraph[0].nodes, 4U);
+  const std::vector<Evaluation> shared = evaluateRuns(found, perGraph, pool);
+  ASSERT_EQ(shared.size(), 2U);
+  EXPECT_DOUBLE_EQ(shared[0].f1, evaluations[0].f1);
+  EXPECT_DOUBLE_EQ(shared[1].f1, evaluations[1].f1);
+
+  // Nodes outside every cluster count towards the entropies of ONMI, as in
+  // the evaluation during a run
+  {
+    std::ofstream truthOut(truth);
+    truthOut << "0 nodes 10\nCluster 1: \n0 1 2 \nCluster 2: \n2 3 \n";
+  }
+  const std::vector<Evaluation> larger =
+      evaluateRuns(found, readClusterFile(truth), pool);
+  std::vector<std::vector<NodeId>> truthLists = {{0, 1, 2}, {2, 3}};
+  const Evaluation inRun =
+      evaluate(ClusterMembership::fromClusters(found[1].clusters, 10),
+               ClusterMembership::fromClusters(truthLists, 10));
+  EXPECT_DOUBLE_EQ(larger[1].onmi, inRun.onmi);
+  EXPECT_NE(larger[1].onmi, shared[1].onmi);
+
+  for (const char *const bad : {"0 0\nnot a cluster\n", "0 nodes\n",
+                                "0 1x\n"}) {
+    {
+      std::ofstream out(clusters);
+      out << bad;
+    }
+    EXPECT_THROW(readClusterFile(clusters), std::runtime_error) << bad;
+  }
+  std::remove(clusters.c_str());
+  std::remove(truth.c_str());
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ClusteredGraph.h"
+#include "EdgeListGraph.h"
+#include "GraphSnapshot.h"
+
+namespace {
+
+bool sameAdjacency(const CSRGraph &a, const CSRGraph &b) {
+  if (a.size() != b.size() || a.entries() != b.entries()) {
+    return false;
+  }
+  for (size_t u = 0; u < a.size(); u++) {
+    if (!std::equal(a[u].begin(), a[u].end(), b[u].begin(), b[u].end())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+TEST(GraphSnapshotTest, RoundTripKeepsGraphAndTruth) {
+  ClusteredGraph generated(50, {0, 5, 2});
+  generated.generateGraph();
+  const std::string path = ::testing::TempDir() + "snapshot_clustered.bin";
+  SnapshotGraph::write(generated, path);
+  EXPECT_TRUE(SnapshotGraph::isSnapshot(path));
+
+  SnapshotGraph loaded(path);
+  loaded.generateGraph();
+  EXPECT_TRUE(sameAdjacency(loaded.getAdjList(), generated.getAdjList()));
+  EXPECT_EQ(loaded.truthClusters(), generated.truthClusters());
+
+  // The adjacency is used where it is mapped and outlives the graph object
+  CSRGraph kept = loaded.getAdjList();
+  loaded.deleteGraph();
+  EXPECT_TRUE(sameAdjacency(kept, generated.getAdjList()));
+  std::remove(path.c_str());
+}
+
+TEST(GraphSnapshotTest, ReleaseHandsOverTheGraph) {
+  ClusteredGraph generated(50, {0, 5, 2});
+  generated.generateGraph();
+  const CSRGraph copy = generated.getAdjList();
+  const auto truth = generated.truthClusters();
+
+  const GeneratedGraph released = generated.release();
+  EXPECT_TRUE(sameAdjacency(released.adjList, copy));
+  EXPECT_EQ(released.clusters, truth);
+  EXPECT_EQ(generated.getAdjList().size(), 0U);
+  EXPECT_TRUE(generated.truthClusters().empty());
+
+  // The next graph is generated as after deleteGraph()
+  generated.generateGraph();
+  EXPECT_EQ(generated.truthClusters().size(), truth.size());
+  EXPECT_EQ(generated.getAdjList().size(), copy.size());
+}
+
+TEST(GraphSnapshotTest, GraphWithoutTruth) {
+  const std::string edges = ::testing::TempDir() + "snapshot_edges.txt";
+  {
+    std::ofstream out(edges);
+    out << "0 1\n1 2\n5 2\n";
+  }
+  EdgeListGraph parsed(edges);
+  parsed.generateGraph();
+  EXPECT_TRUE(parsed.truthClusters().empty());
+  EXPECT_FALSE(SnapshotGraph::isSnapshot(edges));
+
+  const std::string path = ::testing::TempDir() + "snapshot_edges.bin";
+  SnapshotGraph::write(parsed, path);
+  SnapshotGraph loaded(path);
+  loaded.generateGraph();
+  EXPECT_TRUE(sameAdjacency(loaded.getAdjList(), parsed.getAdjList()));
+  EXPECT_TRUE(loaded.truthClusters().empty());
+  std::remove(edges.c_str());
+  std::remove(path.c_str());
+}
+
+TEST(GraphSnapshotTest, RejectsDamagedFiles) {
+  ClusteredGraph generated(20, {0, 2});
+  generated.generateGraph();
+  const std::string path = ::testing::TempDir() + "snapshot_damaged.bin";
+  SnapshotGraph::write(generated, path);
+
+  // Cut off the last bytes
+  std::string bytes;
+  {
+    std::ifstream in(path, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(in),
+                 std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 8));
+  }
+  SnapshotGraph truncated(path);
+  EXPECT_THROW(truncated.generateGraph(), std::runtime_error);
+
+  // Unknown version
+  bytes[8] = 99;
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  }
+  SnapshotGraph newer(path);
+  EXPECT_THROW(newer.generateGraph(), std::runtime_error);
+  std::remove(path.c_str());
+}
@@ -6,6 +6,32 @@
 
 #include "OverCoDe.h"
 
+// Whether nodes u and v are in a common cluster
+static bool shareCluster(const ClusterMembership &clusters, const size_t u,
+                         const size_t v) {
+  for (const ClusterId a : clusters.clustersOf(u)) {
+    for (const ClusterId b : clusters.clustersOf(v)) {
+      if (a == b) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Same clusters with the same representative signatures
+static bool sameResults(const OverCoDe &first, const OverCoDe &second) {
+  if (first.getClusters() != second.getClusters()) {
+    return false;
+  }
+  for (size_t c = 0; c < first.getClusters().clusters(); c++) {
+    if (first.representative(c) != second.representative(c)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 TEST(OverCoDeTest, Semaphore) {
   Semaphore sem(1);
 
@@ -51,24 +77,24 @@ TEST(OverCoDeTest, RunSmokeTest) {
   double beta = 0.6;
   double alpha = 0.6;
 
-  OverCoDe overcode(adjList, T, k, rho, h, ell, beta, alpha);
+  CSRGraph graph(adjList);
+  OverCoDe overcode(graph, T, k, rho, h, ell, beta, alpha);
 
   // Just run the algorithm. We can't easily check the output due to randomness,
   // so this is a "smoke test" to see if it runs without crashing.
   ASSERT_NO_THROW(overcode.runOverCoDe());
 
   // Basic sanity check on the results
-  const auto &results = overcode.getResults();
-  EXPECT_EQ(results.size(), 5); // One result per node
+  const ClusterMembership &clusters = overcode.getClusters();
+  EXPECT_EQ(clusters.nodes(), 5); // One result per node
 
-  const auto clusters = overcode.getClusters();
   // It's possible (though unlikely) no clusters are found if beta/alpha are too
   // high or 'ell' is too low, but with this graph, we expect *some* result.
 
   // Example: Check that node 2 (the overlap) is in more or equal clusters
   // than node 0 (non-overlap). This might not always hold due to randomness,
   // but it's a reasonable heuristic.
-  EXPECT_GE(results[2].size(), results[0].size());
+  EXPECT_GE(clusters.clustersOf(2).size(), clusters.clustersOf(0).size());
 }
 
 TEST(OverCoDeTest, DisjointCliquesSeparation) {
@@ -85,25 +111,305 @@ TEST(OverCoDeTest, DisjointCliquesSeparation) {
   double beta = 0.6; // Low enough that bug (0.5) triggers merge, but logic (0.0) should separate
   double alpha = 0.6;
 
-  OverCoDe overcode(adjList, T, k, rho, h, ell, beta, alpha);
+  CSRGraph graph(adjList);
+  OverCoDe overcode(graph, T, k, rho, h, ell, beta, alpha);
   overcode.runOverCoDe();
 
-  const auto &results = overcode.getResults();
-  
-  // Check if Node 0 and Node 3 share any cluster signature
-  bool sharedCluster = false;
-  for(const auto& sig0 : results[0]) {
-      for(const auto& sig3 : results[3]) {
-          if(sig0 == sig3) {
-              sharedCluster = true;
-          }
-      }
-  }
-  
+  // Check if Node 0 and Node 3 share any cluster
+  bool sharedCluster = shareCluster(overcode.getClusters(), 0, 3);
+
   // With correct logic, they should NOT share a cluster.
   EXPECT_FALSE(sharedCluster) << "Disjoint cliques were merged! Likely due to signature padding bug.";
 }
 
+TEST(OverCoDeTest, ScalarEngineSeparatesDisjointCliques) {
+  // Same setup as DisjointCliquesSeparation, using one task per run
+  std::vector<std::vector<unsigned long long>> adjList(6);
+  adjList[0] = {1, 2}; adjList[1] = {0, 2}; adjList[2] = {0, 1};
+  adjList[3] = {4, 5}; adjList[4] = {3, 5}; adjList[5] = {3, 4};
+
+  OverCoDeOptions options;
+  options.engine = SignatureEngine::Scalar;
+
+  CSRGraph graph(adjList);
+  OverCoDe overcode(graph, 20, 2, 3, 2, 200, 0.6, 0.6, options);
+  overcode.runOverCoDe();
+
+  EXPECT_FALSE(shareCluster(overcode.getClusters(), 0, 3));
+}
+
+TEST(OverCoDeTest, CountSamplingSeparatesDisjointCliques) {
+  std::vector<std::vector<unsigned long long>> adjList(6);
+  adjList[0] = {1, 2}; adjList[1] = {0, 2}; adjList[2] = {0, 1};
+  adjList[3] = {4, 5}; adjList[4] = {3, 5}; adjList[5] = {3, 4};
+
+  OverCoDeOptions options;
+  options.engine = SignatureEngine::Scalar;
+  options.majoritySampling = MajoritySampling::Counts;
+
+  CSRGraph graph(adjList);
+  OverCoDe overcode(graph, 20, 2, 3, 2, 200, 0.6, 0.6, options);
+  overcode.runOverCoDe();
+
+  EXPECT_FALSE(shareCluster(overcode.getClusters(), 0, 3));
+}
+
+TEST(OverCoDeTest, IndexedRepresentativesSeparateDisjointCliques) {
+  std::vector<std::vector<unsigned long long>> adjList(6);
+  adjList[0] = {1, 2}; adjList[1] = {0, 2}; adjList[2] = {0, 1};
+  adjList[3] = {4, 5}; adjList[4] = {3, 5}; adjList[5] = {3, 4};
+
+  OverCoDeOptions options;
+  options.lshRecall = 0.99;
+
+  CSRGraph graph(adjList);
+  OverCoDe overcode(graph, 20, 2, 3, 2, 200, 0.6, 0.6, options);
+  overcode.runOverCoDe();
+
+  EXPECT_FALSE(shareCluster(overcode.getClusters(), 0, 3));
+}
+
+TEST(OverCoDeTest, SeededRunsAreReproducible) {
+  std::vector<std::vector<unsigned long long>> adjList(6);
+  adjList[0] = {1, 2}; adjList[1] = {0, 2}; adjList[2] = {0, 1, 3};
+  adjList[3] = {2, 4, 5}; adjList[4] = {3, 5}; adjList[5] = {3, 4};
+  CSRGraph graph(adjList);
+
+  for (const SignatureEngine engine :
+       {SignatureEngine::Scalar, SignatureEngine::Bitsliced}) {
+    OverCoDeOptions options;
+    options.engine = engine;
+    options.seed = 1234;
+
+    OverCoDe first(graph, 20, 2, 3, 2, 100, 0.6, 0.6, options);
+    OverCoDe second(graph, 20, 2, 3, 2, 100, 0.6, 0.6, options);
+    first.runOverCoDe();
+    second.runOverCoDe();
+    EXPECT_TRUE(sameResults(first, second));
+  }
+}
+
+TEST(OverCoDeTest, NodeParallelRunsMatchSerialRuns) {
+  // Ring of 300 nodes with chords, split unevenly between the members
+  const int n = 300;
+  std::vector<std::vector<unsigned long long>> adjList(n);
+  for (int i = 0; i < n; ++i) {
+    adjList[i].push_back((i + 1) % n);
+    adjList[i].push_back((i + n - 1) % n);
+    adjList[i].push_back((i + n / 2) % n);
+  }
+  CSRGraph graph(adjList);
+
+  for (const SignatureEngine engine :
+       {SignatureEngine::Scalar, SignatureEngine::Bitsliced}) {
+    OverCoDeOptions serial;
+    serial.engine = engine;
+    serial.seed = 99;
+    serial.parallelism = Parallelism::Runs;
+    serial.threads = 1;
+
+    OverCoDeOptions team = serial;
+    team.parallelism = Parallelism::Nodes;
+    team.threads = 3;
+
+    OverCoDe first(graph, 15, 2, 3, 2, 70, 0.6, 0.6, serial);
+    OverCoDe second(graph, 15, 2, 3, 2, 70, 0.6, 0.6, team);
+    first.runOverCoDe();
+    second.runOverCoDe();
+    EXPECT_TRUE(sameResults(first, second));
+  }
+
+  // The neighbor counts are split between the members as well
+  OverCoDeOptions serial;
+  serial.engine = SignatureEngine::Scalar;
+  serial.majoritySampling = MajoritySampling::Counts;
+  serial.seed = 7;
+  serial.parallelism = Parallelism::Runs;
+  serial.threads = 1;
+
+  OverCoDeOptions team = serial;
+  team.parallelism = Parallelism::Nodes;
+  team.threads = 3;
+
+  OverCoDe first(graph, 30, 2, 4, 2, 10, 0.6, 0.6, serial);
+  OverCoDe second(graph, 30, 2, 4, 2, 10, 0.6, 0.6, team);
+  first.runOverCoDe();
+  second.runOverCoDe();
+  EXPECT_TRUE(sameResults(first, second));
+}
+
+TEST(OverCoDeTest, ScalarRunsOnSeveralThreadsMatchOneThread) {
+  // Every run is its own task, so runs of one word of a row are stored by
+  // different threads at once
+  const int n = 200;
+  std::vector<std::vector<unsigned long long>> adjList(n);
+  for (int i = 0; i < n; ++i) {
+    adjList[i].push_back((i + 1) % n);
+    adjList[i].push_back((i + n - 1) % n);
+    adjList[i].push_back((i + 7) % n);
+  }
+  CSRGraph graph(adjList);
+
+  OverCoDeOptions serial;
+  serial.engine = SignatureEngine::Scalar;
+  serial.seed = 5;
+  serial.parallelism = Parallelism::Runs;
+  serial.threads = 1;
+
+  OverCoDeOptions parallel = serial;
+  parallel.threads = 4;
+
+  OverCoDe first(graph, 15, 2, 3, 2, 90, 0.6, 0.6, serial);
+  OverCoDe second(graph, 15, 2, 3, 2, 90, 0.6, 0.6, parallel);
+  first.runOverCoDe();
+  second.runOverCoDe();
+  EXPECT_TRUE(sameResults(first, second));
+}
+
+TEST(OverCoDeTest, DecidedTerminationMatchesFullRuns) {
+  std::vector<std::vector<unsigned long long>> adjList(6);
+  adjList[0] = {1, 2}; adjList[1] = {0, 2}; adjList[2] = {0, 1, 3};
+  adjList[3] = {2, 4, 5}; adjList[4] = {3, 5}; adjList[5] = {3, 4};
+  CSRGraph graph(adjList);
+
+  for (const SignatureEngine engine :
+       {SignatureEngine::Scalar, SignatureEngine::Bitsliced}) {
+    OverCoDeOptions full;
+    full.engine = engine;
+    full.seed = 31;
+    full.termination = Termination::Full;
+
+    OverCoDeOptions decided = full;
+    decided.termination = Termination::Decided;
+
+    OverCoDe first(graph, 40, 2, 3, 2, 100, 0.6, 0.6, full);
+    OverCoDe second(graph, 40, 2, 3, 2, 100, 0.6, 0.6, decided);
+    first.runOverCoDe();
+    second.runOverCoDe();
+    EXPECT_TRUE(sameResults(first, second));
+  }
+}
+
+TEST(OverCoDeTest, SweepMatchesSeparateRuns) {
+  std::vector<std::vector<unsigned long long>> adjList(6);
+  adjList[0] = {1, 2}; adjList[1] = {0, 2}; adjList[2] = {0, 1, 3};
+  adjList[3] = {2, 4, 5}; adjList[4] = {3, 5}; adjList[5] = {3, 4};
+  CSRGraph graph(adjList);
+  const std::vector<double> alphas = {0.55, 0.7};
+  const std::vector<double> betas = {0.5, 0.8};
+
+  for (const SignatureEngine engine :
+       {SignatureEngine::Scalar, SignatureEngine::Bitsliced}) {
+    OverCoDeOptions options;
+    options.engine = engine;
+    options.seed = 31; // the first call of every instance uses the same runs
+
+    OverCoDe sweeper(graph, 40, 2, 3, 2, 100, 0.6, 0.6, options);
+    const std::vector<OverCoDe::SweepResult> results =
+        sweeper.sweep(alphas, betas);
+    ASSERT_EQ(results.size(), 4U);
+
+    for (const OverCoDe::SweepResult &point : results) {
+      OverCoDe single(graph, 40, 2, 3, 2, 100, point.beta, point.alpha,
+                      options);
+      single.runOverCoDe();
+      EXPECT_EQ(point.clusters, single.getClusters());
+      ASSERT_EQ(point.representatives.size(),
+                single.getClusters().clusters());
+      for (size_t c = 0; c < point.representatives.size(); c++) {
+        EXPECT_EQ(point.representatives[c], single.representative(c));
+      }
+    }
+    EXPECT_EQ(results[1].alpha, 0.55);
+    EXPECT_EQ(results[1].beta, 0.8);
+  }
+}
+
+TEST(OverCoDeTest, ProfileCountsEveryRunAndRound) {
+  std::vector<std::vector<unsigned long long>> adjList(6);
+  adjList[0] = {1, 2}; adjList[1] = {0, 2}; adjList[2] = {0, 1};
+  adjList[3] = {4, 5}; adjList[4] = {3, 5}; adjList[5] = {3, 4};
+  CSRGraph graph(adjList);
+
+  for (const SignatureEngine engine :
+       {SignatureEngine::Scalar, SignatureEngine::Bitsliced}) {
+    OverCoDeOptions options;
+    options.engine = engine;
+    options.seed = 17;
+    options.termination = Termination::Full; // every run executes T rounds
+    OverCoDe plain(graph, 20, 2, 3, 2, 70, 0.6, 0.6, options);
+    plain.runOverCoDe();
+    EXPECT_TRUE(plain.profile().workers.empty());
+
+    options.profile = true;
+    OverCoDe profiled(graph, 20, 2, 3, 2, 70, 0.6, 0.6, options);
+    profiled.runOverCoDe();
+    EXPECT_TRUE(sameResults(plain, profiled));
+
+    const RunProfile &profile = profiled.profile();
+    EXPECT_EQ(profile.nodes, 6U);
+    EXPECT_EQ(profile.runs, 70U);
+    EXPECT_EQ(profile.clusters, profiled.getClusters().clusters());
+    EXPECT_GE(profile.pureNodes, profile.clusters);
+    EXPECT_LE(profile.undecidedFraction(), 1.0);
+    EXPECT_GT(profile.totalSeconds, 0.0);
+
+    const PhaseCounters total = profile.total();
+    EXPECT_EQ(total.roundRuns, std::vector<std::uint64_t>(20, 70));
+    for (const double seconds : total.seconds) {
+      EXPECT_GE(seconds, 0.0);
+    }
+  }
+}
+
+TEST(OverCoDeTest, AnytimeModeStopsOnceStable) {
+  std::vector<std::vector<unsigned long long>> adjList(6);
+  adjList[0] = {1, 2}; adjList[1] = {0, 2}; adjList[2] = {0, 1};
+  adjList[3] = {4, 5}; adjList[4] = {3, 5}; adjList[5] = {3, 4};
+  CSRGraph graph(adjList);
+
+  OverCoDeOptions options;
+  options.seed = 5;
+  options.batchRuns = 64;
+  options.stableBatches = 2;
+
+  OverCoDe overcode(graph, 20, 2, 3, 2, 2000, 0.6, 0.6, options);
+  overcode.runOverCoDe();
+  EXPECT_LT(overcode.signatureRuns(), 2000U);
+  EXPECT_EQ(overcode.signatureRuns() % 64, 0U);
+
+  const ClusterMembership &clusters = overcode.getClusters();
+  ASSERT_FALSE(clusters.clustersOf(0).empty());
+  EXPECT_EQ(overcode.representative(clusters.clustersOf(0)[0]).size(),
+            overcode.signatureRuns());
+  EXPECT_FALSE(shareCluster(clusters, 0, 3));
+}
+
+TEST(OverCoDeTest, AnytimeModeWithoutStopMatchesSingleBatch) {
+  std::vector<std::vector<unsigned long long>> adjList(6);
+  adjList[0] = {1, 2}; adjList[1] = {0, 2}; adjList[2] = {0, 1, 3};
+  adjList[3] = {2, 4, 5}; adjList[4] = {3, 5}; adjList[5] = {3, 4};
+  CSRGraph graph(adjList);
+
+  for (const SignatureEngine engine :
+       {SignatureEngine::Scalar, SignatureEngine::Bitsliced}) {
+    OverCoDeOptions single;
+    single.engine = engine;
+    single.seed = 8;
+
+    OverCoDeOptions batched = single;
+    batched.batchRuns = 64;
+    batched.stableBatches = 1000;
+
+    OverCoDe first(graph, 20, 2, 3, 2, 150, 0.6, 0.6, single);
+    OverCoDe second(graph, 20, 2, 3, 2, 150, 0.6, 0.6, batched);
+    first.runOverCoDe();
+    second.runOverCoDe();
+    EXPECT_EQ(second.signatureRuns(), 150U);
+    EXPECT_TRUE(sameResults(first, second));
+  }
+}
+
 TEST(OverCoDeTest, LargeScaleStressTest) {
   // 1000 nodes in a ring
   int n = 1000;
@@ -125,7 +431,8 @@ TEST(OverCoDeTest, LargeScaleStressTest) {
   double beta = 0.6;
   double alpha = 0.6;
 
-  OverCoDe overcode(adjList, T, k, rho, h, ell, beta, alpha);
+  CSRGraph graph(adjList);
+  OverCoDe overcode(graph, T, k, rho, h, ell, beta, alpha);
   
   // Should not crash (OOM) and should finish in reasonable time
   ASSERT_NO_THROW(overcode.runOverCoDe());
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Pipeline.h"
+
+// Contents of a file
+static std::string readFile(const std::string &path) {
+  std::ifstream in(path);
+  std::stringstream contents;
+  contents << in.rdbuf();
+  return contents.str();
+}
+
+TEST(PipelineTest, QueueKeepsOrderAndBound) {
+  BoundedQueue<int> queue(2);
+  std::atomic<int> pushed{0};
+  std::thread producer([&]() {
+    for (int i = 0; i < 100; i++) {
+      ASSERT_TRUE(queue.push(i));
+      pushed++;
+    }
+    queue.close();
+  });
+  std::vector<int> popped;
+  while (std::optional<int> item = queue.pop()) {
+    EXPECT_LE(pushed.load(), *item + 3); // at most two waiting, one in push
+    popped.push_back(*item);
+  }
+  producer.join();
+  ASSERT_EQ(popped.size(), 100U);
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(popped[static_cast<size_t>(i)], i);
+  }
+  EXPECT_FALSE(queue.push(100));
+}
+
+TEST(PipelineTest, PrefetcherStaysAheadAndRethrows) {
+  std::atomic<size_t> produced{0};
+  {
+    Prefetcher<size_t> squares(5, 1, [&](const size_t i) {
+      produced++;
+      return i * i;
+    });
+    for (size_t i = 0; i < 5; i++) {
+      EXPECT_EQ(squares.next(), i * i);
+      EXPECT_LE(produced.load(), i + 2);
+    }
+    EXPECT_THROW(squares.next(), std::out_of_range);
+  }
+
+  Prefetcher<int> failing(3, 1, [](const size_t i) {
+    if (i == 1) {
+      throw std::runtime_error("generator failed");
+    }
+    return 7;
+  });
+  EXPECT_EQ(failing.next(), 7);
+  EXPECT_THROW(failing.next(), std::runtime_error);
+
+  // Destroyed before all items are taken
+  Prefetcher<int> abandoned(1000, 2, [](const size_t) { return 1; });
+  EXPECT_EQ(abandoned.next(), 1);
+}
+
+TEST(PipelineTest, WriterAppendsInOrder) {
+  const std::string first = ::testing::TempDir() + "writer_first";
+  const std::string second = ::testing::TempDir() + "writer_second";
+  {
+    std::ofstream out(first);
+    out << "kept\n";
+  }
+  std::remove(second.c_str());
+
+  FileWriter writer(2);
+  std::string expected = "kept\n";
+  for (int i = 0; i < 50; i++) {
+    writer.append(first, std::to_string(i) + "\n");
+    writer.append(second, "x");
+    expected += std::to_string(i) + "\n";
+  }
+  writer.finish();
+  EXPECT_EQ(readFile(first), expected);
+  EXPECT_EQ(readFile(second), std::string(50, 'x'));
+  std::remove(first.c_str());
+  std::remove(second.c_str());
+
+  FileWriter broken;
+  broken.append(::testing::TempDir() + "missing/dir/file", "text");
+  EXPECT_THROW(broken.finish(), std::runtime_error);
+}
+
+TEST(PipelineTest, SerialStageRunsJobsInOrder) {
+  std::vector<int> order;
+  SerialStage stage(2);
+  for (int i = 0; i < 50; i++) {
+    stage.add([&order, i]() { order.push_back(i); });
+  }
+  stage.finish();
+  ASSERT_EQ(order.size(), 50U);
+  for (int i = 0; i < 50; i++) {
+    EXPECT_EQ(order[static_cast<size_t>(i)], i);
+  }
+
+  std::atomic<int> after{0};
+  SerialStage failing;
+  failing.add([]() { throw std::runtime_error("job failed"); });
+  failing.add([&after]() { after++; });
+  EXPECT_THROW(failing.finish(), std::runtime_error);
+  EXPECT_EQ(after.load(), 0);
+}
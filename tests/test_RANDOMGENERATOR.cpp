@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <cstdint>
 #include <stdexcept>
+#include <vector>
 
 #include "RandomGenerator.h"
 
@@ -56,3 +59,126 @@ TEST(RandomGeneratorTest, InvalidRange) {
   EXPECT_THROW(rand.getRandomDouble(1.0, 0.0), std::invalid_argument);
   EXPECT_THROW(rand.getRandomUll(100ULL, 50ULL), std::invalid_argument);
 }
+
+TEST(RandomGeneratorTest, PhiloxKnownAnswers) {
+  // Known answer vectors of Philox4x32-10 from Random123
+  const Philox4x32::Counter zero =
+      Philox4x32::generate({0, 0, 0, 0}, {0, 0});
+  EXPECT_EQ(zero, (Philox4x32::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c,
+                                       0x9b00dbd8}));
+
+  const Philox4x32::Counter ones = Philox4x32::generate(
+      {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+      {0xffffffff, 0xffffffff});
+  EXPECT_EQ(ones, (Philox4x32::Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6,
+                                       0x6d5451fd}));
+}
+
+TEST(RandomGeneratorTest, CounterStreamDependsOnlyOnPosition) {
+  CounterStream a(123);
+  CounterStream b(123);
+
+  a.position(5, 7, 11);
+  std::vector<std::uint32_t> first(10);
+  a.fill(first.data(), first.size());
+
+  // Unrelated draws before positioning must not matter
+  b.position(1, 2, 3);
+  b.next64();
+  b.position(5, 7, 11);
+  std::vector<std::uint32_t> second(10);
+  b.fill(second.data(), second.size());
+
+  EXPECT_EQ(first, second);
+
+  b.position(5, 7, 12);
+  EXPECT_NE(b.next32(), first[0]);
+}
+
+TEST(RandomGeneratorTest, BoundedDrawsStayInRange) {
+  SequentialStream sequential(42);
+  CounterStream counter(42);
+  counter.position(0, 0, 0);
+  for (const std::uint32_t range : {1U, 2U, 3U, 7U, 1000U, 0x80000001U}) {
+    for (int i = 0; i < 1000; ++i) {
+      EXPECT_LT(sequential.bounded(range), range);
+      EXPECT_LT(counter.bounded(range), range);
+    }
+  }
+}
+
+TEST(RandomGeneratorTest, BoundedDrawsCoverRange) {
+  SequentialStream stream(7);
+  std::vector<int> counts(6, 0);
+  for (int i = 0; i < 6000; ++i) {
+    counts[stream.bounded(6)]++;
+  }
+  for (const int count : counts) {
+    EXPECT_GT(count, 800);
+    EXPECT_LT(count, 1200);
+  }
+}
+
+TEST(RandomGeneratorTest, SeededGeneratorsAreDeterministic) {
+  Xoshiro256pp x1(2024), x2(2024);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(x1(), x2());
+  }
+  EXPECT_NE(Xoshiro256pp(1)(), Xoshiro256pp(2)());
+}
+
+TEST(RandomGeneratorTest, MultinomialPlacesEveryTrial) {
+  SequentialStream stream(11);
+  for (const std::uint32_t trials : {0U, 1U, 50U, 5000U, 100000U}) {
+    std::vector<std::uint32_t> counts(37, 0);
+    uniformMultinomial(stream, trials, 37,
+                       [&](const std::uint32_t cell, const std::uint32_t n) {
+                         counts[cell] += n;
+                       });
+    std::uint64_t total = 0;
+    for (const std::uint32_t count : counts) {
+      total += count;
+    }
+    EXPECT_EQ(total, trials);
+  }
+}
+
+TEST(RandomGeneratorTest, BtrsBinomialMatchesProbabilities) {
+  // Frequencies of every outcome of Bin(40, 0.4), mean 16
+  SequentialStream stream(3);
+  const std::uint32_t trials = 40;
+  const double p = 0.4;
+  const int samples = 200000;
+  std::vector<int> counts(trials + 1, 0);
+  for (int i = 0; i < samples; i++) {
+    counts[btrsBinomial(stream, trials, p)]++;
+  }
+  double mass = std::pow(1 - p, trials);
+  for (std::uint32_t x = 0; x <= trials; x++) {
+    const double expected = mass * samples;
+    EXPECT_NEAR(counts[x], expected, 5 * std::sqrt(expected) + 1) << x;
+    mass *= p / (1 - p) * (trials - x) / (x + 1);
+  }
+}
+
+TEST(RandomGeneratorTest, BinomialMeanMatches) {
+  CounterStream stream(5);
+  stream.position(0, 0, 0);
+  // Small means use inversion, large ones BTRS (on the failures if p > 1/2)
+  for (const double p : {0.005, 0.05, 0.3, 0.8}) {
+    const std::uint32_t trials = 1000;
+    double sum = 0;
+    double squares = 0;
+    const int samples = 20000;
+    for (int i = 0; i < samples; i++) {
+      const std::uint32_t x = binomial(stream, trials, p);
+      ASSERT_LE(x, trials);
+      sum += x;
+      squares += static_cast<double>(x) * x;
+    }
+    const double mean = sum / samples;
+    const double variance = squares / samples - mean * mean;
+    EXPECT_NEAR(mean, trials * p, trials * p * 0.02);
+    EXPECT_NEAR(variance, trials * p * (1 - p), trials * p * (1 - p) * 0.05);
+  }
+}
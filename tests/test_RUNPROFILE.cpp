@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "RunProfile.h"
+
+TEST(RunProfileTest, TotalMergesCallerAndWorkers) {
+  RunProfile profile;
+  profile.workers.resize(2);
+  profile.caller.add(Phase::Purity, 1.0);
+  profile.workers[0].add(Phase::Push, 0.5);
+  profile.workers[1].add(Phase::Push, 0.25);
+  profile.workers[0].addRound(1, 64, 10);
+  profile.workers[1].addRound(3, 0, 4);
+
+  const PhaseCounters total = profile.total();
+  EXPECT_DOUBLE_EQ(total.seconds[static_cast<size_t>(Phase::Push)], 0.75);
+  EXPECT_DOUBLE_EQ(total.seconds[static_cast<size_t>(Phase::Purity)], 1.0);
+  EXPECT_EQ(total.roundRuns, (std::vector<std::uint64_t>{64, 0, 0}));
+  EXPECT_EQ(total.roundFlips, (std::vector<std::uint64_t>{10, 0, 4}));
+
+  profile.nodes = 4;
+  profile.runs = 8;
+  profile.undecided = 8;
+  EXPECT_DOUBLE_EQ(profile.undecidedFraction(), 0.25);
+}
+
+TEST(RunProfileTest, WritesCsvAndJsonRecords) {
+  RunProfile profile;
+  profile.nodes = 10;
+  profile.runs = 64;
+  profile.clusters = 2;
+  profile.caller.addRound(1, 64, 7);
+  profile.caller.addRound(2, 64, 3);
+  profile.caller.add(Phase::Assignment, 0.5);
+  profile.workers.resize(2);
+  profile.workers[0].add(Phase::Push, 2.0);
+  profile.workers[1].add(Phase::Push, 1.0);
+
+  const std::string csv = ::testing::TempDir() + "profile.csv";
+  {
+    ProfileWriter writer(csv);
+    writer.write(profile, 0, 0);
+    writer.write(profile, 0, 1);
+  }
+  std::ifstream csvIn(csv);
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(csvIn, line);) {
+    lines.push_back(line);
+  }
+  ASSERT_EQ(lines.size(), 3U);
+  EXPECT_EQ(lines[0].rfind("graph,run,nodes,runs,total_s,signatures_s,"
+                            "graph_wall_s,push_wall_s",
+                            0),
+            0U);
+  EXPECT_NE(lines[0].find(",assignment_wall_s,graph_thread_s,push_thread_s,"),
+            std::string::npos);
+  EXPECT_EQ(lines[2].rfind("0,1,10,64,", 0), 0U);
+  // pure nodes, clusters, undecided fraction, rounds, flips
+  const std::string counts = ",0,2,0,2,10";
+  EXPECT_EQ(lines[2].substr(lines[2].size() - counts.size()), counts);
+  std::remove(csv.c_str());
+
+  const std::string json = ::testing::TempDir() + "profile.json";
+  {
+    ProfileWriter writer(json);
+    writer.write(profile, 3, 4);
+  }
+  std::ifstream jsonIn(json);
+  std::string record;
+  std::getline(jsonIn, record);
+  EXPECT_EQ(record.rfind("{\"graph\":3,\"run\":4,\"nodes\":10,", 0), 0U);
+  EXPECT_NE(record.find("\"clusters\":2,"), std::string::npos);
+  // Wall clock and summed worker times are kept apart
+  EXPECT_NE(record.find("\"wall_seconds\":{\"total\":0,\"signatures\":0,"
+                        "\"graph\":0,\"push\":0,"),
+            std::string::npos);
+  EXPECT_NE(record.find("\"assignment\":0.5},\"thread_seconds\":{"
+                        "\"graph\":0,\"push\":3,"),
+            std::string::npos);
+  EXPECT_NE(record.find("\"round_runs\":[64,64],\"round_flips\":[7,3]}"),
+            std::string::npos);
+  std::remove(json.c_str());
+}
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "RunTallies.h"
+
+TEST(RunTalliesTest, DecideThresholdsEveryRun) {
+  // T = 10, 70 runs so the second word of a row is partly used
+  RunTallies tallies;
+  tallies.reset(2, 70, 10);
+  for (size_t run = 0; run < 70; run++) {
+    tallies.set(0, run, run % 11);
+    tallies.set(1, run, 10 - run % 11);
+  }
+  EXPECT_EQ(tallies.get(1, 3), 7U);
+
+  ThreadPool pool(2);
+  SignatureMatrix signatures;
+  tallies.decide(0.6, signatures, pool); // R from 6, B up to 4
+  ASSERT_EQ(signatures.rows(), 2U);
+  ASSERT_EQ(signatures.length(), 70U);
+  for (size_t run = 0; run < 70; run++) {
+    const size_t tally = run % 11;
+    const int expected = tally >= 6 ? 0 : (tally <= 4 ? 1 : -1);
+    EXPECT_EQ(signatures.value(0, run), expected) << run;
+  }
+
+  tallies.decide(0.5, signatures, pool); // R from 5, B up to 5: R wins
+  EXPECT_EQ(signatures.value(1, 5), 0);  // tally 5
+  EXPECT_EQ(signatures.value(1, 4), 0);  // tally 6
+  EXPECT_EQ(signatures.value(1, 6), 1);  // tally 4
+}
+
+TEST(RunTalliesTest, RejectsTooManyRounds) {
+  RunTallies tallies;
+  EXPECT_THROW(tallies.reset(1, 1, 70000), std::invalid_argument);
+}
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "SignatureIndex.h"
+
+TEST(SignatureIndexTest, IdenticalSignaturesShareBuckets) {
+  SignatureMatrix matrix(3, 200);
+  for (size_t i = 0; i < 200; i++) {
+    matrix.set(0, i, static_cast<int>(i % 3 == 0));
+    matrix.set(1, i, static_cast<int>(i % 3 == 0));
+    matrix.set(2, i, static_cast<int>(i % 3 != 0));
+  }
+
+  SignatureIndex index(200, 0.9, 0.99);
+  ASSERT_GE(index.tables(), 1U);
+  std::vector<std::uint32_t> keys(3 * index.tables());
+  for (size_t r = 0; r < 3; r++) {
+    index.keys(matrix.row(r), &keys[r * index.tables()]);
+  }
+  index.insert(0, &keys[0]);
+
+  std::vector<std::uint32_t> candidates;
+  index.candidates(&keys[index.tables()], candidates);
+  EXPECT_EQ(candidates, std::vector<std::uint32_t>{0});
+
+  // The complement differs at every position, so at every sampled bit
+  index.candidates(&keys[2 * index.tables()], candidates);
+  EXPECT_TRUE(candidates.empty());
+}
+
+TEST(SignatureIndexTest, HigherRecallUsesMoreTables) {
+  const SignatureIndex coarse(256, 0.9, 0.5);
+  const SignatureIndex fine(256, 0.9, 0.999);
+  EXPECT_LT(coarse.tables(), fine.tables());
+  EXPECT_LE(fine.tables(), SignatureIndex::MAX_TABLES);
+}
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "SignatureMatrix.h"
+
+// Reference similarity on unpacked signatures (-1 = undecided)
+static double referenceSimilarity(const std::vector<int> &a,
+                                  const std::vector<int> &b) {
+  int common = 0, validIndices = 0;
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i] != -1 && b[i] != -1) {
+      validIndices++;
+      if (a[i] == b[i]) {
+        common++;
+      }
+    }
+  }
+  return validIndices == 0 ? 0.0
+                           : static_cast<double>(common) / validIndices;
+}
+
+TEST(SignatureMatrixTest, SetAndValueRoundTrip) {
+  SignatureMatrix matrix(2, 70);
+  matrix.set(1, 0, 0);
+  matrix.set(1, 65, 1);
+  matrix.set(1, 69, 1);
+  matrix.set(1, 69, -1);
+
+  EXPECT_EQ(matrix.value(1, 0), 0);
+  EXPECT_EQ(matrix.value(1, 65), 1);
+  EXPECT_EQ(matrix.value(1, 69), -1);
+  EXPECT_EQ(matrix.value(0, 0), -1);
+  EXPECT_EQ(matrix.decidedCount(1), 2);
+  EXPECT_EQ(matrix.unpack(1).size(), 70);
+}
+
+TEST(SignatureMatrixTest, SetWordFillsSixtyFourPositions) {
+  SignatureMatrix matrix(2, 100);
+  matrix.set(0, 3, 1);
+  // Positions 64.. of row 0: 64 R, 65 B, 66 undecided (colour bit ignored)
+  matrix.setWord(0, 1, 0b011, 0b110);
+
+  EXPECT_EQ(matrix.value(0, 3), 1);
+  EXPECT_EQ(matrix.value(0, 64), 0);
+  EXPECT_EQ(matrix.value(0, 65), 1);
+  EXPECT_EQ(matrix.value(0, 66), -1);
+  EXPECT_EQ(matrix.decidedCount(0), 3);
+  EXPECT_EQ(matrix.decidedCount(1), 0);
+}
+
+TEST(SignatureMatrixTest, SharedSetsOfOneWordFromSeveralThreads) {
+  // Thread t stores the positions i with i % 4 == t, all in the same words
+  SignatureMatrix matrix(3, 128);
+  matrix.set(1, 5, 0);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; t++) {
+    threads.emplace_back([&matrix, t]() {
+      for (int repeat = 0; repeat < 100; repeat++) {
+        for (size_t row = 0; row < matrix.rows(); row++) {
+          for (size_t i = t; i < matrix.length(); i += 4) {
+            matrix.setShared(row, i, static_cast<int>((row + i) % 3) - 1);
+          }
+        }
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  for (size_t row = 0; row < matrix.rows(); row++) {
+    for (size_t i = 0; i < matrix.length(); i++) {
+      EXPECT_EQ(matrix.value(row, i), static_cast<int>((row + i) % 3) - 1);
+    }
+  }
+}
+
+TEST(SignatureMatrixTest, SimilarityExample) {
+  // R B B U R U B vs B B R U R B B -> 3 of 5 common positions agree
+  const std::vector<int> a = {0, 1, 1, -1, 0, -1, 1};
+  const std::vector<int> b = {1, 1, 0, -1, 0, 1, 1};
+  SignatureMatrix matrix(2, a.size());
+  for (size_t i = 0; i < a.size(); i++) {
+    matrix.set(0, i, a[i]);
+    matrix.set(1, i, b[i]);
+  }
+  EXPECT_DOUBLE_EQ(similarity(matrix.row(0), matrix.row(1)), 3.0 / 5.0);
+}
+
+TEST(SignatureMatrixTest, SimilarityMatchesReference) {
+  // Lengths around the 4 and 8 word SIMD blocks and their tails
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> value(-1, 1);
+  for (const size_t length : {1, 63, 64, 200, 256, 600, 1741}) {
+    std::vector<int> a(length), b(length);
+    SignatureMatrix matrix(2, length);
+    for (size_t i = 0; i < length; i++) {
+      a[i] = value(gen);
+      b[i] = value(gen);
+      matrix.set(0, i, a[i]);
+      matrix.set(1, i, b[i]);
+    }
+    EXPECT_DOUBLE_EQ(similarity(matrix.row(0), matrix.row(1)),
+                     referenceSimilarity(a, b))
+        << "length " << length;
+  }
+}
+
+TEST(SignatureMatrixTest, NoCommonPositions) {
+  SignatureMatrix matrix(2, 10);
+  matrix.set(0, 3, 1);
+  matrix.set(1, 4, 1);
+  EXPECT_DOUBLE_EQ(similarity(matrix.row(0), matrix.row(1)), 0.0);
+}
+
+TEST(SignatureMatrixTest, PrunedComparisonMatchesSimilarity) {
+  // Pairs agreeing on about 50% to 100% of the positions
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  for (const size_t length : {64, 300, 1741}) {
+    for (int pair = 0; pair < 50; pair++) {
+      SignatureMatrix matrix(2, length);
+      const double flip = unit(gen) * 0.5;
+      for (size_t i = 0; i < length; i++) {
+        const int a = unit(gen) < 0.1 ? -1 : static_cast<int>(gen() % 2);
+        const int b = a < 0 || unit(gen) >= flip ? a : 1 - a;
+        matrix.set(0, i, a);
+        matrix.set(1, i, unit(gen) < 0.05 ? -1 : b);
+      }
+      const std::uint64_t maxValid =
+          std::min(matrix.decidedCount(0), matrix.decidedCount(1));
+      for (const double threshold : {0.6, 0.85, 0.95}) {
+        EXPECT_EQ(isSimilar(matrix.row(0), matrix.row(1), threshold, maxValid),
+                  similarity(matrix.row(0), matrix.row(1)) >= threshold);
+      }
+    }
+  }
+}
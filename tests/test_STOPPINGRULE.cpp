@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "StoppingRule.h"
+
+TEST(StoppingRuleTest, DecisionsBecomeFixed) {
+  // T = 10, alpha = 0.6: R needs 6 R rounds, B at most 4
+  OverCoDeOptions options;
+  StoppingRule rule(options, 10, 0.6);
+  ASSERT_EQ(rule.minRed(), 6U);
+
+  EXPECT_TRUE(rule.isFixed(6, 6));  // already R
+  EXPECT_FALSE(rule.isFixed(2, 6)); // 2 + 4 may still reach R
+  EXPECT_TRUE(rule.isFixed(0, 6));  // at most 4, always B
+  EXPECT_FALSE(rule.isFixed(3, 8)); // ends B or undecided
+  EXPECT_FALSE(rule.isFixed(5, 9)); // undecided or R
+  EXPECT_TRUE(rule.isFixed(5, 10)); // undecided for good
+}
+
+TEST(StoppingRuleTest, FullModeNeverStops) {
+  OverCoDeOptions options;
+  options.termination = Termination::Full;
+  StoppingRule rule(options, 10, 0.6);
+  EXPECT_FALSE(rule.stop(3, true, 0, 100));
+}
+
+TEST(StoppingRuleTest, StableModeWaitsForPatience) {
+  OverCoDeOptions options;
+  options.termination = Termination::Stable;
+  options.flipEpsilon = 0.1;
+  options.patience = 2;
+  StoppingRule rule(options, 100, 0.6);
+
+  EXPECT_FALSE(rule.stop(1, false, 5, 100));  // quiet
+  EXPECT_FALSE(rule.stop(2, false, 50, 100)); // busy, starts over
+  EXPECT_FALSE(rule.stop(3, false, 5, 100));
+  EXPECT_TRUE(rule.stop(4, false, 0, 100));
+  EXPECT_FALSE(rule.stop(100, true, 0, 100)); // nothing left to skip
+}
+
+TEST(StoppingRuleTest, SweepAlphasMustBeFixedToo) {
+  // T = 10: alpha 0.6 needs 6 R rounds, alpha 0.8 needs 8
+  OverCoDeOptions options;
+  options.sweepAlphas = {0.8};
+  StoppingRule rule(options, 10, 0.6);
+  EXPECT_EQ(rule.minRed(), 6U);
+  EXPECT_EQ(rule.minReds(), (std::vector<std::uint64_t>{6, 8}));
+
+  EXPECT_TRUE(rule.isFixed(6, 6, 6));
+  EXPECT_FALSE(rule.isFixed(6, 6)); // may still reach 8
+  EXPECT_TRUE(rule.isFixed(8, 8));
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -46,3 +47,35 @@ TEST(SyntheticEgoGraphTest, GraphProperties) {
     }
   }
 }
+
+TEST(SyntheticEgoGraphTest, LargeParametricGraphHasSimpleEdges) {
+  EgoGraphParams shape;
+  shape.minClusters = 300;
+  shape.maxClusters = 300;
+  shape.clusterMeanSize = 20;
+  shape.clusterStdDev = 0;
+  shape.minOverlap = 2;
+  shape.maxOverlap = 2;
+  shape.pairProbability = 0.01;
+  SyntheticEgoGraph graph(shape);
+  graph.generateGraph();
+
+  const auto &adjList = graph.getAdjList();
+  const auto clusters = graph.getClusters();
+  ASSERT_EQ(clusters.size(), 300U);
+
+  // Every node but the ego node is counted once per cluster it is in
+  std::set<unsigned long long> nodes;
+  for (const auto &cluster : clusters) {
+    nodes.insert(cluster.begin(), cluster.end());
+  }
+  EXPECT_EQ(adjList.size(), nodes.size());
+
+  const NodeId ego = static_cast<NodeId>(clusters[0].back());
+  EXPECT_EQ(adjList.degree(ego), adjList.size() - 1);
+  for (NodeId u = 0; u < adjList.size(); u++) {
+    const std::set<NodeId> unique(adjList[u].begin(), adjList[u].end());
+    EXPECT_EQ(unique.size(), adjList.degree(u)) << "duplicate edge at " << u;
+    EXPECT_EQ(unique.count(u), 0U) << "self-loop at " << u;
+  }
+}
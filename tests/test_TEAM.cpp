@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "Team.h"
+
+TEST(TeamTest, RangesCoverAllItems) {
+  const size_t total = 10;
+  size_t expectedBegin = 0;
+  for (size_t rank = 0; rank < 3; rank++) {
+    const Team team{rank, 3, nullptr};
+    const auto [begin, end] = team.range(total);
+    EXPECT_EQ(begin, expectedBegin);
+    EXPECT_GE(end - begin, 3U);
+    EXPECT_LE(end - begin, 4U);
+    expectedBegin = end;
+  }
+  EXPECT_EQ(expectedBegin, total);
+}
+
+TEST(TeamTest, PlanPrefersRunLevelParallelism) {
+  // Enough tasks for every thread
+  TeamPlan plan = planTeams(1000000, 100, 8, true);
+  EXPECT_EQ(plan.teams, 8U);
+  EXPECT_EQ(plan.teamSize, 1U);
+
+  // Few tasks on a large graph: spare threads join the tasks
+  plan = planTeams(1000000, 2, 8, true);
+  EXPECT_EQ(plan.teams, 2U);
+  EXPECT_EQ(plan.teamSize, 4U);
+
+  // Few tasks on a small graph: splitting the nodes does not pay off
+  plan = planTeams(2 * MIN_NODES_PER_THREAD, 1, 8, true);
+  EXPECT_EQ(plan.teams, 1U);
+  EXPECT_EQ(plan.teamSize, 2U);
+
+  plan = planTeams(1000000, 2, 8, false);
+  EXPECT_EQ(plan.teams, 2U);
+  EXPECT_EQ(plan.teamSize, 1U);
+}
+
+TEST(TeamTest, BarrierSeparatesPhases) {
+  const size_t size = 4;
+  Barrier barrier(size);
+  std::vector<int> values(size, 0);
+  std::vector<int> seen(size, 0);
+
+  std::vector<std::thread> threads;
+  for (size_t rank = 0; rank < size; rank++) {
+    threads.emplace_back([&, rank]() {
+      const Team team{rank, size, &barrier};
+      for (int phase = 1; phase <= 50; phase++) {
+        values[rank] = phase;
+        team.sync();
+        seen[rank] = values[(rank + 1) % size];
+        team.sync();
+        EXPECT_EQ(seen[rank], phase);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
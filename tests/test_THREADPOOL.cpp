@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "ThreadPool.h"
+
+TEST(ThreadPoolTest, ParallelForVisitsEveryIndexOnce) {
+  ThreadPool pool(4);
+  for (const size_t count : {0, 1, 3, 1000}) {
+    std::vector<int> visits(count, 0);
+    pool.parallelFor(count, [&](const size_t i) { visits[i]++; });
+    for (const int v : visits) {
+      EXPECT_EQ(v, 1);
+    }
+  }
+}
+
+TEST(ThreadPoolTest, ConcurrentCallsMeetAtBarrier) {
+  ThreadPool pool(3);
+  Barrier barrier(3);
+  std::atomic<int> arrived{0};
+  std::vector<int> seen(3, 0);
+
+  // Would deadlock unless all three calls run at the same time
+  for (int round = 0; round < 20; round++) {
+    arrived = 0;
+    pool.concurrently(3, [&](const size_t rank) {
+      arrived++;
+      barrier.wait();
+      seen[rank] = arrived.load();
+    });
+    EXPECT_EQ(seen, std::vector<int>(3, 3));
+  }
+  EXPECT_THROW(pool.concurrently(4, [](size_t) {}), std::logic_error);
+}
+
+TEST(ThreadPoolTest, ArenaKeepsObjects) {
+  ThreadPool pool(2);
+  std::vector<int> &buffer = pool.arena(1).get<std::vector<int>>();
+  buffer.resize(100);
+  EXPECT_EQ(&pool.arena(1).get<std::vector<int>>(), &buffer);
+  EXPECT_EQ(pool.arena(1).get<std::vector<int>>().size(), 100U);
+  EXPECT_TRUE(pool.arena(0).get<std::vector<int>>().empty());
+}
+
+TEST(ThreadPoolTest, NestedWorkRunsInline) {
+  ThreadPool pool(2);
+  std::atomic<int> total{0};
+  pool.parallelFor(8, [&](size_t) {
+    pool.parallelFor(4, [&](size_t) { total++; });
+  });
+  EXPECT_EQ(total.load(), 32);
+}
+
+TEST(ThreadPoolTest, ParallelSortMatchesSort) {
+  ThreadPool pool(4);
+  std::vector<std::uint64_t> values(1 << 19);
+  std::uint64_t state = 1;
+  for (std::uint64_t &value : values) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    value = state >> 40; // plenty of repeats
+  }
+  std::vector<std::uint64_t> expected = values;
+  std::sort(expected.begin(), expected.end());
+
+  parallelSort(pool, values.begin(), values.end());
+  EXPECT_EQ(values, expected);
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "ThreadPool.h"
+#include "Trace.h"
+
+// Contents of a file
+static std::string readFile(const std::string &path) {
+  std::ifstream in(path);
+  std::stringstream contents;
+  contents << in.rdbuf();
+  return contents.str();
+}
+
+// Number of occurrences of needle in text
+static size_t count(const std::string &text, const std::string &needle) {
+  size_t found = 0;
+  for (size_t at = text.find(needle); at != std::string::npos;
+       at = text.find(needle, at + 1)) {
+    found++;
+  }
+  return found;
+}
+
+TEST(TraceTest, RingKeepsTheNewestEvents) {
+  TraceRing ring(3, 0, std::this_thread::get_id());
+  for (std::uint64_t e = 0; e < 5; e++) {
+    ring.record({"event", "index", e, e, e + 1});
+  }
+  const std::vector<TraceEvent> events = ring.ordered();
+  ASSERT_EQ(events.size(), 3U);
+  EXPECT_EQ(events[0].arg, 2U);
+  EXPECT_EQ(events[2].arg, 4U);
+  EXPECT_EQ(ring.dropped(), 2U);
+}
+
+TEST(TraceTest, WritesOneTrackPerThread) {
+  Tracer tracer;
+  { TraceScope scope(&tracer, "main", "value", 7); }
+  std::thread other([&tracer]() {
+    TraceScope outer(&tracer, "outer");
+    TraceScope inner(&tracer, "inner");
+  });
+  other.join();
+  { TraceScope disabled(nullptr, "never"); }
+
+  const std::string path = ::testing::TempDir() + "trace.json";
+  tracer.write(path);
+  const std::string trace = readFile(path);
+  EXPECT_EQ(trace.rfind("{\"traceEvents\":[", 0), 0U);
+  EXPECT_EQ(count(trace, "\"thread_name\""), 2U);
+  EXPECT_EQ(count(trace, "\"ph\":\"X\""), 3U);
+  EXPECT_NE(trace.find("\"name\":\"main\",\"ph\":\"X\",\"pid\":1,\"tid\":0"),
+            std::string::npos);
+  EXPECT_NE(trace.find("\"name\":\"inner\",\"ph\":\"X\",\"pid\":1,\"tid\":1"),
+            std::string::npos);
+  EXPECT_NE(trace.find("\"args\":{\"value\":7}"), std::string::npos);
+  EXPECT_EQ(trace.find("never"), std::string::npos);
+  EXPECT_NE(trace.find("\"dropped_events\":0"), std::string::npos);
+  std::remove(path.c_str());
+}
+
+TEST(TraceTest, PoolRecordsItsTasks) {
+  Tracer tracer;
+  ThreadPool pool(3);
+  pool.setTracer(&tracer);
+  pool.parallelFor(100, [](size_t) {});
+  pool.concurrently(3, [](size_t) {});
+  pool.setTracer(nullptr);
+  pool.parallelFor(100, [](size_t) {});
+
+  const std::string path = ::testing::TempDir() + "pool_trace.json";
+  tracer.write(path);
+  const std::string trace = readFile(path);
+  EXPECT_EQ(count(trace, "\"name\":\"chunk\""), 12U); // 4 per thread
+  EXPECT_EQ(count(trace, "\"name\":\"member\""), 3U);
+  std::remove(path.c_str());
+}